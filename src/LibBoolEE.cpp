@@ -145,6 +145,121 @@ bool LibBoolEE::resolveRec(const std::string &source, const Vals & valuation, Er
     }
 }
 
+bool LibBoolEE::compile(const std::string &source, Program & program) {
+    program.vars.clear();
+    program.code.clear();
+    try {
+        compileRec(removeWhitespaces(source), program);
+    } catch (const std::runtime_error&) {
+        program.vars.clear();
+        program.code.clear();
+        return false;
+    }
+    return true;
+}
+
+void LibBoolEE::compileRec(const std::string &source, Program & program) {
+    if (source.empty()) {
+        throw std::runtime_error("An empty subexpression was encountered");
+    }
+
+    char current_op = '|';
+    std::vector<std::string> subexpressions = singleParse(source, current_op);
+    if (subexpressions.size() == 1) {
+        current_op = '&';
+        subexpressions = singleParse(source, current_op);
+    }
+
+    if (subexpressions.size() == 0) {
+        throw std::runtime_error("The subexpression " + source + " is not a valid formula.");
+    }
+    else if (subexpressions.size() == 1) {
+        if (source[0] == '!') {
+            compileRec(removeWhitespaces(source.substr(1)), program);
+            program.code.emplace_back(Program::NOT, 0);
+        }
+        else if (source[0] == '(') {
+            compileRec(removeWhitespaces(source.substr(1, source.size() - 2)), program);
+        }
+        else if (source == "1") {
+            program.code.emplace_back(Program::PUSH_TRUE, 0);
+        }
+        else if (source == "0") {
+            program.code.emplace_back(Program::PUSH_FALSE, 0);
+        }
+        else {
+            for (const char ch : source) {
+                if (!belongsToName(ch)) {
+                    throw std::runtime_error("Invalid variable name '" + source + "'.");
+                }
+            }
+            size_t index = 0;
+            while (index < program.vars.size() && program.vars[index] != source) {
+                index++;
+            }
+            if (index == program.vars.size()) {
+                if (index == Program::MAX_VARIABLES) {
+                    throw std::runtime_error("Too many variables to compile.");
+                }
+                program.vars.push_back(source);
+            }
+            program.code.emplace_back(Program::PUSH_VAR, static_cast<uint8_t>(index));
+        }
+    }
+    else {
+        if (subexpressions.size() > UINT8_MAX) {
+            throw std::runtime_error("Too many subexpressions to compile.");
+        }
+        for (std::vector<std::string>::iterator it = subexpressions.begin(); it != subexpressions.end(); it++) {
+            compileRec(removeWhitespaces(*it), program);
+        }
+        program.code.emplace_back(current_op == '|' ? Program::OR : Program::AND, static_cast<uint8_t>(subexpressions.size()));
+    }
+
+    if (program.code.size() > Program::MAX_CODE_SIZE) {
+        throw std::runtime_error("The formula is too long to compile.");
+    }
+}
+
+bool LibBoolEE::Program::evaluate(uint64_t values) const {
+    // The stack never holds more entries than there are instructions
+    bool stack[MAX_CODE_SIZE];
+    size_t top = 0;
+    for (const auto& instruction : code) {
+        switch (instruction.first) {
+            case PUSH_VAR:
+                stack[top++] = (values >> instruction.second) & 1;
+                break;
+            case PUSH_TRUE:
+                stack[top++] = true;
+                break;
+            case PUSH_FALSE:
+                stack[top++] = false;
+                break;
+            case NOT:
+                stack[top - 1] = !stack[top - 1];
+                break;
+            case AND: {
+                bool result = true;
+                for (uint8_t i = 0; i < instruction.second; i++) {
+                    result &= stack[--top];
+                }
+                stack[top++] = result;
+                break;
+            }
+            case OR: {
+                bool result = false;
+                for (uint8_t i = 0; i < instruction.second; i++) {
+                    result |= stack[--top];
+                }
+                stack[top++] = result;
+                break;
+            }
+        }
+    }
+    return top == 1 && stack[0];
+}
+
 std::string LibBoolEE::trim(const std::string &source) {
     static const std::string WHITESPACES = " \n\r\t\v\f";
     const size_t front = source.find_first_not_of(WHITESPACES);
@@ -34,6 +34,7 @@ this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "assets/assets.h"
 
 #include <map>
+#include <stdint.h>
 #include <string>
 #include <vector>
 #include <utility>
@@ -44,9 +45,31 @@ public:
     typedef std::map<std::string, bool> Vals; ///< Valuation of atomic propositions
     typedef std::pair<std::string, bool> Val; ///< A single proposition valuation
 
+    /// A formula compiled into postfix bytecode. Variables are numbered in the order they first appear, and the
+    /// valuation is a bitset over those numbers, so evaluating needs no string handling.
+    class Program {
+    public:
+        static const size_t MAX_VARIABLES = 64;
+        static const size_t MAX_CODE_SIZE = 256;
+
+        std::vector<std::string> vars; ///< Variable names, indexed by their bit in the valuation
+
+        // @return	true iff the formula is true when every variable whose bit is set in values is true
+        bool evaluate(uint64_t values) const;
+
+    private:
+        friend class LibBoolEE;
+
+        enum Op : uint8_t { PUSH_VAR, PUSH_TRUE, PUSH_FALSE, NOT, AND, OR };
+        std::vector<std::pair<uint8_t, uint8_t>> code; ///< (op, operand) pairs
+    };
+
     // @return	true iff the formula is true under the valuation (where the valuation are pairs (variable,value))
     static bool resolve(const std::string & source, const Vals & valuation,  ErrorReport* errorReport = nullptr);
 
+    // @return	true iff the formula parses; the program then gives the same result as resolve for any valuation of its variables
+    static bool compile(const std::string & source, Program & program);
+
     // @return  new string made from the source by removing whitespaces
     static std::string removeWhitespaces(const std::string & source);
 
@@ -62,6 +85,9 @@ private:
     // @return	true iff the formula is true under the valuation (where the valuation are pairs (variable,value))---used internally
     static bool resolveRec(const std::string & source, const Vals & valuation, ErrorReport* errorReport = nullptr);
 
+    // Emits the postfix code for the formula, following the same parse as resolveRec---used internally
+    static void compileRec(const std::string & source, Program & program);
+
 
     // @return	new string made from the source by removing the leading and trailing white spaces
     static std::string trim(const std::string & source);
@@ -310,6 +310,220 @@ struct CAddressIndexIteratorHeightKey {
     }
 };
 
+/** Id of YAI in the address index. Other assets are numbered from 1 in the order the index first sees them */
+static const uint32_t ADDRESS_INDEX_YAI_ID = 0;
+
+/**
+ * On-disk key of an address index entry. It holds the same fields as CAddressIndexKey, but is fixed-width: the asset
+ * is an id interned by the block tree database instead of its name, and all integers are big-endian. The entries of
+ * an address therefore sort by asset, height, position in the block and output, and a key whose trailing fields are
+ * zero is the first key of its prefix.
+ */
+struct CAddressIndexDiskKey {
+    static const size_t SIZE = 70;
+
+    uint8_t type;
+    uint160 hashBytes;
+    uint32_t assetId;
+    uint32_t blockHeight;
+    uint32_t txindex;
+    uint256 txhash;
+    uint32_t index;
+    bool spending;
+
+    size_t GetSerializeSize() const {
+        return SIZE;
+    }
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        ser_writedata8(s, type);
+        hashBytes.Serialize(s);
+        ser_writedata32be(s, assetId);
+        ser_writedata32be(s, blockHeight);
+        ser_writedata32be(s, txindex);
+        txhash.Serialize(s);
+        ser_writedata32be(s, index);
+        ser_writedata8(s, spending);
+    }
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        type = ser_readdata8(s);
+        hashBytes.Unserialize(s);
+        assetId = ser_readdata32be(s);
+        blockHeight = ser_readdata32be(s);
+        txindex = ser_readdata32be(s);
+        txhash.Unserialize(s);
+        index = ser_readdata32be(s);
+        spending = ser_readdata8(s);
+    }
+
+    CAddressIndexDiskKey(const CAddressIndexKey& key, uint32_t id) {
+        type = key.type;
+        hashBytes = key.hashBytes;
+        assetId = id;
+        blockHeight = key.blockHeight;
+        txindex = key.txindex;
+        txhash = key.txhash;
+        index = key.index;
+        spending = key.spending;
+    }
+
+    /** The first key of an address, or of one of its assets from a given height */
+    CAddressIndexDiskKey(unsigned int addressType, uint160 addressHash, uint32_t id = 0, int height = 0) {
+        SetNull();
+        type = addressType;
+        hashBytes = addressHash;
+        assetId = id;
+        blockHeight = height;
+    }
+
+    CAddressIndexDiskKey() {
+        SetNull();
+    }
+
+    void SetNull() {
+        type = 0;
+        hashBytes.SetNull();
+        assetId = 0;
+        blockHeight = 0;
+        txindex = 0;
+        txhash.SetNull();
+        index = 0;
+        spending = false;
+    }
+
+    CAddressIndexKey ToKey(const std::string& assetName) const {
+        return CAddressIndexKey(type, hashBytes, assetName, blockHeight, txindex, txhash, index, spending);
+    }
+};
+
+/** On-disk key of an unspent output in the address index, fixed-width like CAddressIndexDiskKey */
+struct CAddressUnspentDiskKey {
+    static const size_t SIZE = 61;
+
+    uint8_t type;
+    uint160 hashBytes;
+    uint32_t assetId;
+    uint256 txhash;
+    uint32_t index;
+
+    size_t GetSerializeSize() const {
+        return SIZE;
+    }
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        ser_writedata8(s, type);
+        hashBytes.Serialize(s);
+        ser_writedata32be(s, assetId);
+        txhash.Serialize(s);
+        ser_writedata32be(s, index);
+    }
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        type = ser_readdata8(s);
+        hashBytes.Unserialize(s);
+        assetId = ser_readdata32be(s);
+        txhash.Unserialize(s);
+        index = ser_readdata32be(s);
+    }
+
+    CAddressUnspentDiskKey(const CAddressUnspentKey& key, uint32_t id) {
+        type = key.type;
+        hashBytes = key.hashBytes;
+        assetId = id;
+        txhash = key.txhash;
+        index = key.index;
+    }
+
+    /** The first key of an address, or of one of its assets */
+    CAddressUnspentDiskKey(unsigned int addressType, uint160 addressHash, uint32_t id = 0) {
+        SetNull();
+        type = addressType;
+        hashBytes = addressHash;
+        assetId = id;
+    }
+
+    CAddressUnspentDiskKey() {
+        SetNull();
+    }
+
+    void SetNull() {
+        type = 0;
+        hashBytes.SetNull();
+        assetId = 0;
+        txhash.SetNull();
+        index = 0;
+    }
+
+    CAddressUnspentKey ToKey(const std::string& assetName) const {
+        return CAddressUnspentKey(type, hashBytes, assetName, txhash, index);
+    }
+};
+
+/**
+ * On-disk value of an unspent output in the address index. Pay to public key hash and pay to script hash scripts,
+ * which are all but a few of them, are not stored but rebuilt from the address in the key. Other scripts (pay to
+ * public key, asset transfers) are stored as they are.
+ */
+struct CAddressUnspentDiskValue {
+    enum : uint8_t {
+        SCRIPT_STORED = 0,
+        SCRIPT_P2PKH = 1,
+        SCRIPT_P2SH = 2,
+    };
+
+    uint64_t satoshis;
+    uint32_t blockHeight;
+    uint8_t scriptType;
+    CScript script;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(VARINT(satoshis));
+        READWRITE(VARINT(blockHeight));
+        READWRITE(scriptType);
+        if (scriptType == SCRIPT_STORED)
+            READWRITE(*(CScriptBase*)(&script));
+    }
+
+    static CScript GetP2PKHScript(const uint160& hashBytes) {
+        return CScript() << OP_DUP << OP_HASH160 << ToByteVector(hashBytes) << OP_EQUALVERIFY << OP_CHECKSIG;
+    }
+
+    static CScript GetP2SHScript(const uint160& hashBytes) {
+        return CScript() << OP_HASH160 << ToByteVector(hashBytes) << OP_EQUAL;
+    }
+
+    CAddressUnspentDiskValue(const CAddressUnspentValue& value, const uint160& hashBytes) {
+        satoshis = value.satoshis;
+        blockHeight = value.blockHeight;
+        if (value.script == GetP2PKHScript(hashBytes)) {
+            scriptType = SCRIPT_P2PKH;
+        } else if (value.script == GetP2SHScript(hashBytes)) {
+            scriptType = SCRIPT_P2SH;
+        } else {
+            scriptType = SCRIPT_STORED;
+            script = value.script;
+        }
+    }
+
+    CAddressUnspentDiskValue() {
+        satoshis = 0;
+        blockHeight = 0;
+        scriptType = SCRIPT_STORED;
+    }
+
+    CAddressUnspentValue ToValue(const uint160& hashBytes) const {
+        if (scriptType == SCRIPT_P2PKH)
+            return CAddressUnspentValue(satoshis, GetP2PKHScript(hashBytes), blockHeight);
+        if (scriptType == SCRIPT_P2SH)
+            return CAddressUnspentValue(satoshis, GetP2SHScript(hashBytes), blockHeight);
+        return CAddressUnspentValue(satoshis, script, blockHeight);
+    }
+};
+
 struct CMempoolAddressDelta
 {
     int64_t time;
@@ -73,6 +73,17 @@ extern "C"{
 #define AES_BIG_ENDIAN   0
 #include "aes_helper.c"
 
+/*
+ * On x86-64 the ECHO-512 compression function also has an AES-NI
+ * version, selected at runtime when the CPU supports it. The portable
+ * code below remains the fallback.
+ */
+#if !defined SPH_NO_AESNI && defined __x86_64__ \
+	&& (defined __GNUC__ || defined __clang__)
+#define SPH_ECHO_AESNI   1
+#include <immintrin.h>
+#endif
+
 #if SPH_ECHO_64
 
 #define DECL_STATE_SMALL   \
@@ -719,11 +730,93 @@ echo_small_compress(sph_echo_small_context *sc)
 	COMPRESS_SMALL(sc);
 }
 
+#if SPH_ECHO_AESNI
+
+static int echo_aesni_enabled = 1;
+
+/*
+ * One ECHO round is two AES rounds on each of the 16 words (the first
+ * keyed by the 128-bit counter, the second with a zero key), followed
+ * by ShiftRows and MixColumns on the 4x4 matrix of words.
+ */
+#define AESNI_XTIME(x)   _mm_xor_si128(_mm_add_epi8(x, x), \
+	_mm_and_si128(_mm_cmpgt_epi8(zero, x), m1b))
+
+#define AESNI_MIX_COLUMN(a, b, c, d)   do { \
+		__m128i ab = _mm_xor_si128(W[a], W[b]); \
+		__m128i bc = _mm_xor_si128(W[b], W[c]); \
+		__m128i cd = _mm_xor_si128(W[c], W[d]); \
+		__m128i abx = AESNI_XTIME(ab); \
+		__m128i bcx = AESNI_XTIME(bc); \
+		__m128i cdx = AESNI_XTIME(cd); \
+		__m128i wa = _mm_xor_si128(abx, _mm_xor_si128(bc, W[d])); \
+		__m128i wb = _mm_xor_si128(bcx, _mm_xor_si128(W[a], cd)); \
+		__m128i wc = _mm_xor_si128(cdx, _mm_xor_si128(ab, W[d])); \
+		__m128i wd = _mm_xor_si128(_mm_xor_si128(abx, bcx), \
+			_mm_xor_si128(cdx, _mm_xor_si128(ab, W[c]))); \
+		W[a] = wa; \
+		W[b] = wb; \
+		W[c] = wc; \
+		W[d] = wd; \
+	} while (0)
+
+__attribute__((target("aes,sse4.1")))
+static void
+echo_big_compress_aesni(sph_echo_big_context *sc)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i m1b = _mm_set1_epi8(0x1B);
+	sph_u64 Klo = (sph_u64)sc->C0 | ((sph_u64)sc->C1 << 32);
+	sph_u64 Khi = (sph_u64)sc->C2 | ((sph_u64)sc->C3 << 32);
+	__m128i W[16];
+	__m128i t;
+	unsigned u, n;
+
+	for (u = 0; u < 8; u ++) {
+		W[u] = _mm_loadu_si128((const __m128i *)sc->u.Vb[u]);
+		W[u + 8] = _mm_loadu_si128((const __m128i *)(sc->buf + 16 * u));
+	}
+	for (u = 0; u < 10; u ++) {
+		for (n = 0; n < 16; n ++) {
+			__m128i K = _mm_set_epi64x((long long)Khi, (long long)Klo);
+			W[n] = _mm_aesenc_si128(_mm_aesenc_si128(W[n], K), zero);
+			if ((Klo = Klo + 1) == 0)
+				Khi ++;
+		}
+		t = W[1]; W[1] = W[5]; W[5] = W[9]; W[9] = W[13]; W[13] = t;
+		t = W[2]; W[2] = W[10]; W[10] = t;
+		t = W[6]; W[6] = W[14]; W[14] = t;
+		t = W[15]; W[15] = W[11]; W[11] = W[7]; W[7] = W[3]; W[3] = t;
+		AESNI_MIX_COLUMN(0, 1, 2, 3);
+		AESNI_MIX_COLUMN(4, 5, 6, 7);
+		AESNI_MIX_COLUMN(8, 9, 10, 11);
+		AESNI_MIX_COLUMN(12, 13, 14, 15);
+	}
+	for (u = 0; u < 8; u ++) {
+		__m128i V = _mm_loadu_si128((const __m128i *)sc->u.Vb[u]);
+		__m128i M = _mm_loadu_si128((const __m128i *)(sc->buf + 16 * u));
+		V = _mm_xor_si128(V, _mm_xor_si128(M,
+			_mm_xor_si128(W[u], W[u + 8])));
+		_mm_storeu_si128((__m128i *)sc->u.Vb[u], V);
+	}
+}
+
+#undef AESNI_XTIME
+#undef AESNI_MIX_COLUMN
+
+#endif
+
 static void
 echo_big_compress(sph_echo_big_context *sc)
 {
 	DECL_STATE_BIG
 
+#if SPH_ECHO_AESNI
+	if (echo_aesni_enabled && __builtin_cpu_supports("aes")) {
+		echo_big_compress_aesni(sc);
+		return;
+	}
+#endif
 	COMPRESS_BIG(sc);
 }
 
@@ -1026,6 +1119,19 @@ sph_echo512_addbits_and_close(void *cc, unsigned ub, unsigned n, void *dst)
 {
 	echo_big_close(cc, ub, n, dst, 16);
 }
+
+/* see sph_echo.h */
+int
+sph_echo512_set_aesni(int enable)
+{
+#if SPH_ECHO_AESNI
+	echo_aesni_enabled = enable;
+	return enable && __builtin_cpu_supports("aes");
+#else
+	(void)enable;
+	return 0;
+#endif
+}
 #ifdef __cplusplus
 }
 #endif
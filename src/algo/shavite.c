@@ -64,6 +64,17 @@ extern "C"{
 #define AES_BIG_ENDIAN   0
 #include "aes_helper.c"
 
+/*
+ * On x86-64 the SHAvite-512 compression function also has an AES-NI
+ * version, selected at runtime when the CPU supports it. The portable
+ * code below remains the fallback.
+ */
+#if !defined SPH_NO_AESNI && defined __x86_64__ \
+	&& (defined __GNUC__ || defined __clang__)
+#define SPH_SHAVITE_AESNI   1
+#include <immintrin.h>
+#endif
+
 static const sph_u32 IV224[] = {
 	C32(0x6774F31C), C32(0x990AE210), C32(0xC87D4274), C32(0xC9546371),
 	C32(0x62B2AEA8), C32(0x4B5801D8), C32(0x1B702860), C32(0x842F3017)
@@ -1475,6 +1486,117 @@ c512(sph_shavite_big_context *sc, const void *msg)
 
 #endif
 
+#if SPH_SHAVITE_AESNI
+
+static int shavite_aesni_enabled = 1;
+
+/*
+ * Same computation as c512(), with each 128-bit block held in a single
+ * register. The unkeyed AES round followed by a key XOR is exactly what
+ * AESENC computes, so most of them are folded into one instruction.
+ */
+__attribute__((target("aes,sse4.1")))
+static void
+c512_aesni(sph_shavite_big_context *sc, const void *msg)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i rk[112];
+	__m128i p0, p1, p2, p3, t;
+	size_t u;
+	int r, s;
+
+	for (u = 0; u < 8; u ++)
+		rk[u] = _mm_loadu_si128((const __m128i *)msg + u);
+	u = 8;
+	for (;;) {
+		for (s = 0; s < 4; s ++) {
+			t = _mm_aesenc_si128(
+				_mm_shuffle_epi32(rk[u - 8], 0x39), zero);
+			rk[u] = _mm_xor_si128(t, rk[u - 1]);
+			if (u == 8) {
+				rk[u] = _mm_xor_si128(rk[u], _mm_set_epi32(
+					(int)SPH_T32(~sc->count3), (int)sc->count2,
+					(int)sc->count1, (int)sc->count0));
+			} else if (u == 110) {
+				rk[u] = _mm_xor_si128(rk[u], _mm_set_epi32(
+					(int)SPH_T32(~sc->count2), (int)sc->count3,
+					(int)sc->count0, (int)sc->count1));
+			}
+			u ++;
+
+			t = _mm_aesenc_si128(
+				_mm_shuffle_epi32(rk[u - 8], 0x39), zero);
+			rk[u] = _mm_xor_si128(t, rk[u - 1]);
+			if (u == 41) {
+				rk[u] = _mm_xor_si128(rk[u], _mm_set_epi32(
+					(int)SPH_T32(~sc->count0), (int)sc->count1,
+					(int)sc->count2, (int)sc->count3));
+			} else if (u == 79) {
+				rk[u] = _mm_xor_si128(rk[u], _mm_set_epi32(
+					(int)SPH_T32(~sc->count1), (int)sc->count0,
+					(int)sc->count3, (int)sc->count2));
+			}
+			u ++;
+		}
+		if (u == 112)
+			break;
+		for (s = 0; s < 8; s ++) {
+			rk[u] = _mm_xor_si128(rk[u - 8],
+				_mm_alignr_epi8(rk[u - 1], rk[u - 2], 4));
+			u ++;
+		}
+	}
+
+	p0 = _mm_loadu_si128((const __m128i *)sc->h + 0);
+	p1 = _mm_loadu_si128((const __m128i *)sc->h + 1);
+	p2 = _mm_loadu_si128((const __m128i *)sc->h + 2);
+	p3 = _mm_loadu_si128((const __m128i *)sc->h + 3);
+	u = 0;
+	for (r = 0; r < 14; r ++) {
+#define C512_ELT_AESNI(l, x)   do { \
+		t = _mm_xor_si128(x, rk[u]); \
+		t = _mm_aesenc_si128(t, rk[u + 1]); \
+		t = _mm_aesenc_si128(t, rk[u + 2]); \
+		t = _mm_aesenc_si128(t, rk[u + 3]); \
+		t = _mm_aesenc_si128(t, zero); \
+		l = _mm_xor_si128(l, t); \
+		u += 4; \
+	} while (0)
+
+		C512_ELT_AESNI(p0, p1);
+		C512_ELT_AESNI(p2, p3);
+		t = p3;
+		p3 = p2;
+		p2 = p1;
+		p1 = p0;
+		p0 = t;
+
+#undef C512_ELT_AESNI
+	}
+	_mm_storeu_si128((__m128i *)sc->h + 0, _mm_xor_si128(
+		_mm_loadu_si128((const __m128i *)sc->h + 0), p0));
+	_mm_storeu_si128((__m128i *)sc->h + 1, _mm_xor_si128(
+		_mm_loadu_si128((const __m128i *)sc->h + 1), p1));
+	_mm_storeu_si128((__m128i *)sc->h + 2, _mm_xor_si128(
+		_mm_loadu_si128((const __m128i *)sc->h + 2), p2));
+	_mm_storeu_si128((__m128i *)sc->h + 3, _mm_xor_si128(
+		_mm_loadu_si128((const __m128i *)sc->h + 3), p3));
+}
+
+#endif
+
+static void
+shavite_big_compress(sph_shavite_big_context *sc, const void *msg)
+{
+#if SPH_SHAVITE_AESNI
+	if (shavite_aesni_enabled && __builtin_cpu_supports("aes")) {
+		c512_aesni(sc, msg);
+		return;
+	}
+#endif
+	c512(sc, msg);
+}
+
 static void
 shavite_small_init(sph_shavite_small_context *sc, const sph_u32 *iv)
 {
@@ -1590,7 +1712,7 @@ shavite_big_core(sph_shavite_big_context *sc, const void *data, size_t len)
 					}
 				}
 			}
-			c512(sc, buf);
+			shavite_big_compress(sc, buf);
 			ptr = 0;
 		}
 	}
@@ -1624,7 +1746,7 @@ shavite_big_close(sph_shavite_big_context *sc,
 	} else {
 		buf[ptr ++] = z;
 		memset(buf + ptr, 0, 128 - ptr);
-		c512(sc, buf);
+		shavite_big_compress(sc, buf);
 		memset(buf, 0, 110);
 		sc->count0 = sc->count1 = sc->count2 = sc->count3 = 0;
 	}
@@ -1634,7 +1756,7 @@ shavite_big_close(sph_shavite_big_context *sc,
 	sph_enc32le(buf + 122, count3);
 	buf[126] = out_size_w32 << 5;
 	buf[127] = out_size_w32 >> 3;
-	c512(sc, buf);
+	shavite_big_compress(sc, buf);
 	for (u = 0; u < out_size_w32; u ++)
 		sph_enc32le((unsigned char *)dst + (u << 2), sc->h[u]);
 }
@@ -1759,6 +1881,19 @@ sph_shavite512_addbits_and_close(void *cc, unsigned ub, unsigned n, void *dst)
 	shavite_big_init(cc, IV512);
 }
 
+/* see sph_shavite.h */
+int
+sph_shavite512_set_aesni(int enable)
+{
+#if SPH_SHAVITE_AESNI
+	shavite_aesni_enabled = enable;
+	return enable && __builtin_cpu_supports("aes");
+#else
+	(void)enable;
+	return 0;
+#endif
+}
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -306,6 +306,17 @@ void sph_shavite512_close(void *cc, void *dst);
  */
 void sph_shavite512_addbits_and_close(
 	void *cc, unsigned ub, unsigned n, void *dst);
+
+/**
+ * Allow or forbid the AES-NI implementation of the SHAvite-512
+ * compression function (allowed by default). It is only used on x86-64
+ * CPUs which support AES-NI; otherwise the portable code is used. This
+ * is not thread-safe and is meant for tests and benchmarks.
+ *
+ * @param enable   non-zero to allow the AES-NI code
+ * @return  non-zero if SHAvite-512 now runs on the AES-NI code
+ */
+int sph_shavite512_set_aesni(int enable);
 	
 #ifdef __cplusplus
 }
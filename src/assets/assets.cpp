@@ -2089,6 +2089,36 @@ bool CAssetsCache::RemoveTransfer(const CAssetTransfer &transfer, const std::str
     return true;
 }
 
+/** Returns what the restricted database holds for the address, loading it into passetsAddressRestrictionCache on a miss */
+static std::shared_ptr<const CAddressRestrictionData> GetAddressRestrictionData(const std::string& address)
+{
+    if (passetsAddressRestrictionCache && passetsAddressRestrictionCache->Exists(address))
+        return passetsAddressRestrictionCache->Get(address);
+
+    auto data = std::make_shared<CAddressRestrictionData>();
+    if (prestricteddb && prestricteddb->ReadAddressRestrictionData(address, *data) && passetsAddressRestrictionCache)
+        passetsAddressRestrictionCache->Put(address, data);
+
+    return data;
+}
+
+/** Applies a qualifier or restriction change that is being written to the restricted database to the cached entry of its address */
+static void UpdateAddressRestrictionData(const std::string& address, const std::string& assetName, bool fQualifier, bool fAdd)
+{
+    if (!passetsAddressRestrictionCache || !passetsAddressRestrictionCache->Exists(address))
+        return;
+
+    // Entries are shared with callers that are still evaluating against them, so copy before changing
+    auto data = std::make_shared<CAddressRestrictionData>(*passetsAddressRestrictionCache->Get(address));
+    std::set<std::string>& setNames = fQualifier ? data->setQualifiers : data->setRestrictions;
+    if (fAdd)
+        setNames.insert(assetName);
+    else
+        setNames.erase(assetName);
+
+    passetsAddressRestrictionCache->Put(address, data);
+}
+
 //! Changes Memory Only, this only called when adding a block to the chain
 bool CAssetsCache::AddQualifierAddress(const std::string& assetName, const std::string& address, const QualifierType type)
 {
@@ -2579,7 +2609,7 @@ bool CAssetsCache::DumpCacheToDatabase()
         // Add the new qualifier commands to the database
         for (auto newQualifierAddress : setNewQualifierAddressToAdd) {
             if (newQualifierAddress.type == QualifierType::REMOVE_QUALIFIER) {
-                passetsQualifierCache->Erase(newQualifierAddress.GetHash().GetHex());
+                UpdateAddressRestrictionData(newQualifierAddress.address, newQualifierAddress.assetName, true, false);
                 if (!prestricteddb->EraseAddressQualifier(newQualifierAddress.address, newQualifierAddress.assetName)) {
                     dirty = true;
                     message = "_Failed Erasing address qualifier from database";
@@ -2592,7 +2622,7 @@ bool CAssetsCache::DumpCacheToDatabase()
                     }
                 }
             } else if (newQualifierAddress.type == QualifierType::ADD_QUALIFIER) {
-                passetsQualifierCache->Put(newQualifierAddress.GetHash().GetHex(), 1);
+                UpdateAddressRestrictionData(newQualifierAddress.address, newQualifierAddress.assetName, true, true);
                 if (!prestricteddb->WriteAddressQualifier(newQualifierAddress.address, newQualifierAddress.assetName))
                 {
                     dirty = true;
@@ -2615,7 +2645,7 @@ bool CAssetsCache::DumpCacheToDatabase()
         // Undo the qualifier commands
         for (auto undoQualifierAddress : setNewQualifierAddressToRemove) {
             if (undoQualifierAddress.type == QualifierType::REMOVE_QUALIFIER) { // If we are undoing a removal, we write the data to database
-                passetsQualifierCache->Put(undoQualifierAddress.GetHash().GetHex(), 1);
+                UpdateAddressRestrictionData(undoQualifierAddress.address, undoQualifierAddress.assetName, true, true);
                 if (!prestricteddb->WriteAddressQualifier(undoQualifierAddress.address, undoQualifierAddress.assetName)) {
                     dirty = true;
                     message = "_Failed undoing a removal of a address qualifier  from database";
@@ -2628,7 +2658,7 @@ bool CAssetsCache::DumpCacheToDatabase()
                     }
                 }
             } else if (undoQualifierAddress.type == QualifierType::ADD_QUALIFIER) { // If we are undoing an addition, we remove the data from the database
-                passetsQualifierCache->Erase(undoQualifierAddress.GetHash().GetHex());
+                UpdateAddressRestrictionData(undoQualifierAddress.address, undoQualifierAddress.assetName, true, false);
                 if (!prestricteddb->EraseAddressQualifier(undoQualifierAddress.address, undoQualifierAddress.assetName))
                 {
                     dirty = true;
@@ -2651,13 +2681,13 @@ bool CAssetsCache::DumpCacheToDatabase()
         // Add new restricted address commands
         for (auto newRestrictedAddress : setNewRestrictedAddressToAdd) {
             if (newRestrictedAddress.type == RestrictedType::UNFREEZE_ADDRESS) {
-                passetsRestrictionCache->Erase(newRestrictedAddress.GetHash().GetHex());
+                UpdateAddressRestrictionData(newRestrictedAddress.address, newRestrictedAddress.assetName, false, false);
                 if (!prestricteddb->EraseRestrictedAddress(newRestrictedAddress.address, newRestrictedAddress.assetName)) {
                     dirty = true;
                     message = "_Failed Erasing restricted address from database";
                 }
             } else if (newRestrictedAddress.type == RestrictedType::FREEZE_ADDRESS) {
-                passetsRestrictionCache->Put(newRestrictedAddress.GetHash().GetHex(), 1);
+                UpdateAddressRestrictionData(newRestrictedAddress.address, newRestrictedAddress.assetName, false, true);
                 if (!prestricteddb->WriteRestrictedAddress(newRestrictedAddress.address, newRestrictedAddress.assetName))
                 {
                     dirty = true;
@@ -2673,13 +2703,13 @@ bool CAssetsCache::DumpCacheToDatabase()
         // Undo the qualifier addresses from database
         for (auto undoRestrictedAddress : setNewRestrictedAddressToRemove) {
             if (undoRestrictedAddress.type == RestrictedType::UNFREEZE_ADDRESS) { // If we are undoing an unfreeze, we need to freeze the address
-                passetsRestrictionCache->Put(undoRestrictedAddress.GetHash().GetHex(), 1);
+                UpdateAddressRestrictionData(undoRestrictedAddress.address, undoRestrictedAddress.assetName, false, true);
                 if (!prestricteddb->WriteRestrictedAddress(undoRestrictedAddress.address, undoRestrictedAddress.assetName)) {
                     dirty = true;
                     message = "_Failed undoing a removal of a restricted address from database";
                 }
             } else if (undoRestrictedAddress.type == RestrictedType::FREEZE_ADDRESS) { // If we are undoing a freeze, we need to unfreeze the address
-                passetsRestrictionCache->Erase(undoRestrictedAddress.GetHash().GetHex());
+                UpdateAddressRestrictionData(undoRestrictedAddress.address, undoRestrictedAddress.assetName, false, false);
                 if (!prestricteddb->EraseRestrictedAddress(undoRestrictedAddress.address, undoRestrictedAddress.assetName))
                 {
                     dirty = true;
@@ -4637,6 +4667,12 @@ bool CAssetsCache::GetAssetVerifierStringIfExists(const std::string &name, CNull
 }
 
 bool CAssetsCache::CheckForAddressQualifier(const std::string &qualifier_name, const std::string& address, bool fSkipTempCache)
+{
+    std::shared_ptr<const CAddressRestrictionData> addressData;
+    return CheckForAddressQualifier(qualifier_name, address, addressData, fSkipTempCache);
+}
+
+bool CAssetsCache::CheckForAddressQualifier(const std::string &qualifier_name, const std::string& address, std::shared_ptr<const CAddressRestrictionData>& addressData, bool fSkipTempCache)
 {
     /** There are circumstances where a blocks transactions could be removing or adding a qualifier to an address,
      * While at the same time a transaction is added to the same block that is trying to transfer to the same address.
@@ -4707,27 +4743,11 @@ bool CAssetsCache::CheckForAddressQualifier(const std::string &qualifier_name, c
         }
     }
 
-    // Check the cache, if it doesn't exist in the cache. Try and read it from database
-    if (passetsQualifierCache) {
-        if (passetsQualifierCache->Exists(cachedQualifierAddress.GetHash().GetHex())) {
-            return true;
-        }
-    }
-
-    if (prestricteddb) {
-        // Check for exact qualifier, and add to cache if it exists
-        if (prestricteddb->ReadAddressQualifier(address, qualifier_name)) {
-            passetsQualifierCache->Put(cachedQualifierAddress.GetHash().GetHex(), 1);
-            return true;
-        }
-
-        // Look for sub qualifiers
-        if (prestricteddb->CheckForAddressRootQualifier(address, qualifier_name)){
-            return true;
-        }
-    }
+    // Check the address's database entry for the exact qualifier or a sub qualifier, loading it once per address
+    if (!addressData)
+        addressData = GetAddressRestrictionData(address);
 
-    return false;
+    return addressData->HasQualifier(qualifier_name);
 }
 
 
@@ -4770,23 +4790,8 @@ bool CAssetsCache::CheckForAddressRestriction(const std::string &restricted_name
         return setIterator->type == RestrictedType::FREEZE_ADDRESS;
     }
 
-    // Check the cache, if it doesn't exist in the cache. Try and read it from database
-    if (passetsRestrictionCache) {
-        if (passetsRestrictionCache->Exists(cachedRestrictedAddress.GetHash().GetHex())) {
-            return true;
-        }
-    }
-
-    if (prestricteddb) {
-        if (prestricteddb->ReadRestrictedAddress(address, restricted_name)) {
-            if (passetsRestrictionCache) {
-                passetsRestrictionCache->Put(cachedRestrictedAddress.GetHash().GetHex(), 1);
-            }
-            return true;
-        }
-    }
-
-    return false;
+    // Check the address's database entry, loading it into the cache if it isn't there
+    return GetAddressRestrictionData(address)->HasRestriction(restricted_name);
 }
 
 bool CAssetsCache::CheckForGlobalRestriction(const std::string &restricted_name, bool fSkipTempCache)
@@ -5139,19 +5144,54 @@ bool ContextualCheckVerifierAssetTxOut(const CTxOut& txout, CAssetsCache* assetC
     return true;
 }
 
+struct CCompiledVerifierString
+{
+    std::set<std::string> setQualifiers;
+    LibBoolEE::Program program;
+    std::vector<std::string> vecProgramQualifiers; // Qualifier asset names of program.vars, in bit order
+};
+
+/** Returns the compiled form of a verifier string that is already known to pass CheckVerifierString, or nullptr if it can't be compiled */
+static std::shared_ptr<const CCompiledVerifierString> CompileVerifierString(const std::string& verifier, const std::set<std::string>& setFoundQualifiers)
+{
+    auto compiled = std::make_shared<CCompiledVerifierString>();
+    compiled->setQualifiers = setFoundQualifiers;
+    if (!LibBoolEE::compile(verifier, compiled->program))
+        return nullptr;
+
+    for (const auto& var : compiled->program.vars)
+        compiled->vecProgramQualifiers.emplace_back(QUALIFIER_CHAR + var);
+
+    if (passetsCompiledVerifierCache)
+        passetsCompiledVerifierCache->Put(verifier, compiled);
+
+    return compiled;
+}
+
 bool ContextualCheckVerifierString(CAssetsCache* cache, const std::string& verifier, const std::string& check_address, std::string& strError, ErrorReport* errorReport)
 {
     // If verifier is set to true, return true
     if (verifier == "true")
         return true;
 
+    // Verifier strings that passed the non contextual checks before are cached in their compiled form
+    std::shared_ptr<const CCompiledVerifierString> compiled;
+    if (passetsCompiledVerifierCache && passetsCompiledVerifierCache->Exists(verifier))
+        compiled = passetsCompiledVerifierCache->Get(verifier);
+
     // Check against the non contextual changes first
     std::set<std::string> setFoundQualifiers;
-    if (!CheckVerifierString(verifier, setFoundQualifiers, strError, errorReport))
-        return false;
+    if (!compiled) {
+        if (!CheckVerifierString(verifier, setFoundQualifiers, strError, errorReport))
+            return false;
+
+        compiled = CompileVerifierString(verifier, setFoundQualifiers);
+    }
+
+    const std::set<std::string>& setQualifiers = compiled ? compiled->setQualifiers : setFoundQualifiers;
 
     // Loop through each qualifier and make sure that the asset exists
-    for(auto qualifier : setFoundQualifiers) {
+    for(auto qualifier : setQualifiers) {
         std::string search = QUALIFIER_CHAR + qualifier;
         if (!cache->CheckIfAssetExists(search, true)) {
             if (errorReport) {
@@ -5169,50 +5209,64 @@ bool ContextualCheckVerifierString(CAssetsCache* cache, const std::string& verif
     if (check_address.empty())
         return true;
 
-    // Create an object that stores if an address contains a qualifier
-    LibBoolEE::Vals vals;
+    bool ret;
+    if (compiled) {
+        // Set the bit of each qualifier the address holds, and evaluate the bytecode against it
+        std::shared_ptr<const CAddressRestrictionData> addressData;
+        uint64_t nQualifierBits = 0;
+        for (size_t i = 0; i < compiled->vecProgramQualifiers.size(); i++) {
+            if (cache->CheckForAddressQualifier(compiled->vecProgramQualifiers[i], check_address, addressData, true))
+                nQualifierBits |= uint64_t(1) << i;
+        }
 
-    // Add the qualifiers into the vals object
-    for (auto qualifier : setFoundQualifiers) {
-        std::string search = QUALIFIER_CHAR + qualifier;
+        ret = compiled->program.evaluate(nQualifierBits);
+    } else {
+        // Create an object that stores if an address contains a qualifier
+        LibBoolEE::Vals vals;
+        std::shared_ptr<const CAddressRestrictionData> addressData;
 
-        // Check to see if the address contains the qualifier
-        bool has_qualifier = cache->CheckForAddressQualifier(search, check_address, true);
+        // Add the qualifiers into the vals object
+        for (auto qualifier : setFoundQualifiers) {
+            std::string search = QUALIFIER_CHAR + qualifier;
 
-        // Add the true or false value into the vals
-        vals.insert(std::make_pair(qualifier, has_qualifier));
-    }
+            // Check to see if the address contains the qualifier
+            bool has_qualifier = cache->CheckForAddressQualifier(search, check_address, addressData, true);
+
+            // Add the true or false value into the vals
+            vals.insert(std::make_pair(qualifier, has_qualifier));
+        }
+
+        try {
+            ret = LibBoolEE::resolve(verifier, vals, errorReport);
+        } catch (const std::runtime_error& run_error) {
 
-    try {
-        bool ret = LibBoolEE::resolve(verifier, vals, errorReport);
-        if (!ret) {
             if (errorReport) {
                 if (errorReport->type == ErrorReport::ErrorType::NotSetError) {
-                    errorReport->type = ErrorReport::ErrorType::FailedToVerifyAgainstAddress;
-                    errorReport->vecUserData.emplace_back(check_address);
-                    errorReport->strDevData = "bad-txns-null-verifier-address-failed-verification";
+                    errorReport->type = ErrorReport::ErrorType::InvalidSyntax;
                 }
+
+                errorReport->vecUserData.emplace_back(run_error.what());
+                errorReport->strDevData = "bad-txns-null-verifier-failed-contexual-syntax-check";
             }
 
-            error("%s : The address %s failed to verify against: %s. Is null %d", __func__, check_address, verifier, errorReport ? 0 : 1);
-            strError = "bad-txns-null-verifier-address-failed-verification";
+            strError = "bad-txns-null-verifier-failed-contexual-syntax-check";
+            return error("%s : Verifier string failed to resolve. Please check string syntax - exception: %s\n", __func__, run_error.what());
         }
-        return ret;
-
-    } catch (const std::runtime_error& run_error) {
+    }
 
+    if (!ret) {
         if (errorReport) {
             if (errorReport->type == ErrorReport::ErrorType::NotSetError) {
-                errorReport->type = ErrorReport::ErrorType::InvalidSyntax;
+                errorReport->type = ErrorReport::ErrorType::FailedToVerifyAgainstAddress;
+                errorReport->vecUserData.emplace_back(check_address);
+                errorReport->strDevData = "bad-txns-null-verifier-address-failed-verification";
             }
-
-            errorReport->vecUserData.emplace_back(run_error.what());
-            errorReport->strDevData = "bad-txns-null-verifier-failed-contexual-syntax-check";
         }
 
-        strError = "bad-txns-null-verifier-failed-contexual-syntax-check";
-        return error("%s : Verifier string failed to resolve. Please check string syntax - exception: %s\n", __func__, run_error.what());
+        error("%s : The address %s failed to verify against: %s. Is null %d", __func__, check_address, verifier, errorReport ? 0 : 1);
+        strError = "bad-txns-null-verifier-address-failed-verification";
     }
+    return ret;
 }
 
 bool ContextualCheckTransferAsset(CAssetsCache* assetCache, const CAssetTransfer& transfer, const std::string& address, std::string& strError)
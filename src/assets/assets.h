@@ -15,6 +15,7 @@
 #include <map>
 #include <unordered_map>
 #include <list>
+#include <memory>
 
 // Asset serialization magic bytes (consensus-critical)
 // Prefix bytes spell "yai" in ASCII, operation types are "qto" + reissue 'r'
@@ -311,6 +312,9 @@ public :
     //! Return true if the address has the given qualifier assigned to it
     bool CheckForAddressQualifier(const std::string &qualifier_name, const std::string& address, bool fSkipTempCache = false);
 
+    //! Same as above, but loads the address's database entry into addressData only if it is empty, so several qualifiers cost one lookup
+    bool CheckForAddressQualifier(const std::string &qualifier_name, const std::string& address, std::shared_ptr<const CAddressRestrictionData>& addressData, bool fSkipTempCache = false);
+
     //! Return true if the address is marked as frozen
     bool CheckForAddressRestriction(const std::string &restricted_name, const std::string& address, bool fSkipTempCache = false);
 
@@ -559,6 +563,9 @@ void ExtractVerifierStringQualifiers(const std::string& verifier, std::set<std::
 bool CheckVerifierString(const std::string& verifier, std::set<std::string>& setFoundQualifiers, std::string& strError, ErrorReport* errorReport = nullptr);
 std::string GetStrippedVerifierString(const std::string& verifier);
 
+/** A verifier string that passed CheckVerifierString, parsed once into bytecode (see passetsCompiledVerifierCache) */
+struct CCompiledVerifierString;
+
 /** Helper methods that validate changes to null asset data transaction databases */
 bool VerifyNullAssetDataFlag(const int& flag, std::string& strError);
 bool VerifyQualifierChange(CAssetsCache& cache, const CNullAssetTxData& data, const std::string& address, std::string& strError);
@@ -24,3 +24,12 @@ uint256 CAssetCacheRestrictedAddress::GetHash() {
 uint256 CAssetCacheRootQualifierChecker::GetHash() {
     return Hash(rootAssetName.begin(), rootAssetName.end(), address.begin(), address.end());
 }
+
+bool CAddressRestrictionData::HasQualifier(const std::string& qualifier) const {
+    // The qualifier and its sub qualifiers (qualifier + "/...") all share its prefix, so they sort together
+    for (auto it = setQualifiers.lower_bound(qualifier); it != setQualifiers.end() && it->compare(0, qualifier.size(), qualifier) == 0; ++it) {
+        if (it->size() == qualifier.size() || (*it)[qualifier.size()] == '/')
+            return true;
+    }
+    return false;
+}
@@ -8,6 +8,7 @@
 #include <string>
 #include <sstream>
 #include <list>
+#include <set>
 #include <unordered_map>
 #include "amount.h"
 #include "script/standard.h"
@@ -498,6 +499,21 @@ struct CAssetCacheRestrictedAddress
     uint256 GetHash();
 };
 
+/** The qualifiers and restrictions the restricted database holds for a single address */
+struct CAddressRestrictionData
+{
+    std::set<std::string> setQualifiers;
+    std::set<std::string> setRestrictions;
+
+    //! True if the address has the qualifier, or any of its sub qualifiers
+    bool HasQualifier(const std::string& qualifier) const;
+
+    bool HasRestriction(const std::string& restricted) const
+    {
+        return setRestrictions.count(restricted) > 0;
+    }
+};
+
 struct CAssetCacheRestrictedGlobal
 {
     std::string assetName;
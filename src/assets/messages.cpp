@@ -7,9 +7,11 @@
 #include <wallet/wallet.h>
 #include <script/ismine.h>
 #include <base58.h>
+#include <init.h>
 #include "messages.h"
 #include "myassetsdb.h"
 #include <primitives/block.h>
+#include <memusage.h>
 
 
 std::set<COutPoint> setDirtyMessagesRemove;
@@ -25,6 +27,10 @@ std::set<std::string> setAddressAskedForFalse;
 
 CCriticalSection cs_messaging;
 
+int64_t nMessageDirtyCacheLimit = nMaxMessageDirtyCache << 20;
+
+static CMessageFlushStats messageFlushStats;
+
 
 int8_t IntFromMessageStatus(MessageStatus status)
 {
@@ -187,74 +193,119 @@ void OrphanMessage(const CMessage& message)
 }
 
 #ifdef ENABLE_WALLET
-bool ScanForMessageChannels(std::string& strError)
+static void ScanOutputForMessageChannels(const CTxOut& out, CWallet* pwallet)
 {
-    LOCK2(cs_messaging, cs_main);
+    int nType = -1;
+    bool fOwner = false;
+    if (pwallet->IsMine(out) != ISMINE_SPENDABLE || !out.scriptPubKey.IsAssetScript(nType, fOwner))
+        return;
+
+    CAssetOutputEntry assetData;
+    // Get the asset data from the script
+    if (!GetAssetData(out.scriptPubKey, assetData)) {
+        LogPrintf("%s : Failed to get GetAssetData call\n", __func__);
+        return;
+    }
 
-    LogPrintf("%s : Start Scanning For Message Channels\n", __func__);
+    AssetType type;
+    IsAssetNameValid(assetData.assetName, type);
+
+    if (assetData.type == TX_TRANSFER_ASSET) {
+        if (type == AssetType::MSGCHANNEL || type == AssetType::OWNER) { // Subscribe to any channels or owner tokens you own
+            AddChannel(assetData.assetName);
+            AddAddressSeen(EncodeDestination(assetData.destination));
+        } else if (type == AssetType::ROOT || type == AssetType::SUB) { // Subscribe to any assets you are sent, if they are sent to a new address
+            if (!IsChannelSubscribed(assetData.assetName + OWNER_TAG)) {
+                if (!IsAddressSeen(EncodeDestination(assetData.destination))) {
+                    AddChannel(assetData.assetName + OWNER_TAG);
+                    AddAddressSeen(EncodeDestination(assetData.destination));
+                }
+            }
+        }
+    } else if (assetData.type == TX_NEW_ASSET || assetData.type == TX_REISSUE_ASSET) {
+        if (fOwner || type == AssetType::MSGCHANNEL) {
+            AddChannel(assetData.assetName);
+            AddAddressSeen(EncodeDestination(assetData.destination));
+        } else if (type == AssetType::ROOT || type == AssetType::SUB || type == AssetType::RESTRICTED) {
+            AddChannel(assetData.assetName + "!");
+            AddAddressSeen(EncodeDestination(assetData.destination));
+        }
+    }
+}
 
+static bool SaveMessageChannelScanHeight(int nHeight, std::string& strError)
+{
+    // The channels found so far must hit the database before the cursor moves past them
+    if (!pmessagechanneldb->Flush() || !pmessagechanneldb->WriteScanHeight(nHeight)) {
+        strError = "Failed to save the message channel scan progress";
+        return false;
+    }
+    return true;
+}
+
+bool ScanForMessageChannels(std::string& strError)
+{
     if (vpwallets.size() == 0) {
         strError = "Wallet isn't active on this client. Can't scan for MsgChannels";
         return false;
     }
 
-    CBlockIndex* blockIndex = chainActive[GetParams().GetAssetActivationHeight()];
+    if (!pmessagechanneldb) {
+        strError = "Message channel database isn't setup";
+        return false;
+    }
 
-    while (blockIndex) {
-        CBlock block;
-        if (!ReadBlockFromDisk(block, blockIndex, GetParams().GetConsensus())) {
-            strError = "Block not found on disk";
-            return false;
+    CWallet* pwallet = vpwallets[0];
+
+    // Resume after the last height a previous scan finished
+    int nStartHeight = GetParams().GetAssetActivationHeight();
+    int nScannedHeight;
+    if (pmessagechanneldb->ReadScanHeight(nScannedHeight))
+        nStartHeight = std::max(nStartHeight, nScannedHeight + 1);
+
+    LogPrintf("%s : Start Scanning For Message Channels from height %d\n", __func__, nStartHeight);
+
+    // Every asset output the wallet owns is in its transaction records, so they are scanned instead of the block files
+    std::vector<std::pair<uint256, CTransactionRef>> vWalletTxes;
+    {
+        LOCK(pwallet->cs_wallet);
+        vWalletTxes.reserve(pwallet->mapWallet.size());
+        for (const auto& item : pwallet->mapWallet) {
+            if (!item.second.hashUnset())
+                vWalletTxes.emplace_back(item.second.hashBlock, item.second.tx);
         }
+    }
 
-        for (const auto& tx : block.vtx) {
+    // cs_main is only held to map the block hashes to active chain heights
+    std::vector<std::pair<int, CTransactionRef>> vConfirmedTxes;
+    int nTipHeight;
+    {
+        LOCK(cs_main);
+        nTipHeight = chainActive.Height();
+        for (const auto& item : vWalletTxes) {
+            BlockMap::iterator mi = mapBlockIndex.find(item.first);
+            if (mi == mapBlockIndex.end() || !chainActive.Contains(mi->second) || mi->second->nHeight < nStartHeight)
+                continue;
+            vConfirmedTxes.emplace_back(mi->second->nHeight, item.second);
+        }
+    }
 
-            auto ptx = tx.get();
-            if (!ptx) {
-                strError = "Failed to get transaction pointer";
-                return false;
-            }
+    std::stable_sort(vConfirmedTxes.begin(), vConfirmedTxes.end(),
+                     [](const std::pair<int, CTransactionRef>& a, const std::pair<int, CTransactionRef>& b) { return a.first < b.first; });
 
-            for (auto out : ptx->vout) {
-                int nType = -1;
-                bool fOwner = false;
-                if (vpwallets[0]->IsMine(out) == ISMINE_SPENDABLE) { // Is the out mine
-                    if (out.scriptPubKey.IsAssetScript(nType, fOwner)) {
-                        CAssetOutputEntry assetData;
-                        // Get the asset data from the script
-                        if (GetAssetData(out.scriptPubKey, assetData)) {
-                            AssetType type;
-                            IsAssetNameValid(assetData.assetName, type);
-
-                            if (assetData.type == TX_TRANSFER_ASSET) {
-                                if (type == AssetType::MSGCHANNEL || type == AssetType::OWNER) { // Subscribe to any channels or owner tokens you own
-                                    AddChannel(assetData.assetName);
-                                    AddAddressSeen(EncodeDestination(assetData.destination));
-                                } else if (type == AssetType::ROOT || type == AssetType::SUB) { // Subscribe to any assets you are sent, if they are sent to a new address
-                                    if (!IsChannelSubscribed(assetData.assetName + OWNER_TAG)) {
-                                        if (!IsAddressSeen(EncodeDestination(assetData.destination))) {
-                                            AddChannel(assetData.assetName + OWNER_TAG);
-                                            AddAddressSeen(EncodeDestination(assetData.destination));
-                                        }
-                                    }
-                                }
-                            } else if (assetData.type == TX_NEW_ASSET || assetData.type == TX_REISSUE_ASSET) {
-                                if (fOwner || type == AssetType::MSGCHANNEL) {
-                                    AddChannel(assetData.assetName);
-                                    AddAddressSeen(EncodeDestination(assetData.destination));
-                                } else if (type == AssetType::ROOT || type == AssetType::SUB || type == AssetType::RESTRICTED) {
-                                    AddChannel(assetData.assetName + "!");
-                                    AddAddressSeen(EncodeDestination(assetData.destination));
-                                }
-                            }
-                        } else {
-                            LogPrintf("%s : Failed to get GetAssetData call\n", __func__);
-                        }
-                    }
-                }
-            }
+    LOCK(cs_messaging);
+
+    for (const auto& item : vConfirmedTxes) {
+        if (ShutdownRequested()) {
+            // Everything below this height has been scanned, pick up from here on the next start
+            if (!SaveMessageChannelScanHeight(item.first - 1, strError))
+                return false;
+            strError = "Message channel scan interrupted";
+            return false;
         }
-        blockIndex = chainActive[blockIndex->nHeight + 1];
+
+        for (const auto& out : item.second->vout)
+            ScanOutputForMessageChannels(out, pwallet);
     }
 
     LogPrintf("%s : Finished Scanning For Message Channels. Subscribed Messages Channels Found: %u\n", __func__, setDirtyChannelsAdd.size());
@@ -262,7 +313,8 @@ bool ScanForMessageChannels(std::string& strError)
         LogPrintf("%s, ",item);
     }
     LogPrintf("\n");
-    return true;
+
+    return SaveMessageChannelScanHeight(nTipHeight, strError);
 }
 #endif
 
@@ -300,37 +352,66 @@ void AddAddressSeen(const std::string &address)
 
 size_t GetMessageDirtyCacheSize()
 {
-    // COutPoint: 32 bytes
-    // CNewAsset: Max 80 bytes
-    // CAssetTransfer: Asset Name, CAmount ( 40 bytes)
-    // CReissueAsset: Max 80 bytes
-    // CAmount: 8 bytes
-    // Asset Name: Max 32 bytes
-    // Address: 40 bytes
-    // Block hash: 32 bytes
-    // CTxOut: CAmount + CScript (105 + 8 = 113 bytes)
-    // CMessage: Max 123 Bytes
-
+    // COutPoint: 36 bytes
+    // CMessage: Max 123 Bytes of payload (channel name and ipfs hash) on top of the struct
+    // Channel name / Address: Max 40 bytes of string payload
 
     size_t size = 0;
     // Messages Caches
-    size += 32 * setDirtyMessagesRemove.size(); // COutPoint;
-    size += (32 + 123) * mapDirtyMessagesAdd.size(); // COutPoint -> CMessage
-    size += (32 + 123) * mapDirtyMessagesOrphaned.size(); // COutPoint -> CMessage
-
+    size += memusage::DynamicUsage(setDirtyMessagesRemove);
+    size += memusage::DynamicUsage(mapDirtyMessagesAdd) + 123 * mapDirtyMessagesAdd.size();
+    size += memusage::DynamicUsage(mapDirtyMessagesOrphaned) + 123 * mapDirtyMessagesOrphaned.size();
 
     // Message Channel Caches
-    size += 32 * setDirtyChannelsAdd.size();
-    size += 32 * setDirtyChannelsRemove.size();
-    size += 32 * setSubscribedChannelsAskedForFalse.size();
+    size += memusage::DynamicUsage(setDirtyChannelsAdd) + 40 * setDirtyChannelsAdd.size();
+    size += memusage::DynamicUsage(setDirtyChannelsRemove) + 40 * setDirtyChannelsRemove.size();
+    size += memusage::DynamicUsage(setSubscribedChannelsAskedForFalse) + 40 * setSubscribedChannelsAskedForFalse.size();
 
     // Address Seen Caches
-    size += 32 * setDirtySeenAddressAdd.size();
-    size += 32 * setAddressAskedForFalse.size();
+    size += memusage::DynamicUsage(setDirtySeenAddressAdd) + 40 * setDirtySeenAddressAdd.size();
+    size += memusage::DynamicUsage(setAddressAskedForFalse) + 40 * setAddressAskedForFalse.size();
 
     return size;
 }
 
+CMessageFlushStats GetMessageFlushStats()
+{
+    return messageFlushStats;
+}
+
+bool FlushMessageDatabases()
+{
+    AssertLockHeld(cs_messaging);
+
+    size_t nSize = GetMessageDirtyCacheSize();
+    int64_t nStart = GetTimeMicros();
+
+    if (pmessagedb && !pmessagedb->Flush())
+        return error("%s: Failed to Flush the message database", __func__);
+
+    if (pmessagechanneldb && !pmessagechanneldb->Flush())
+        return error("%s: Failed to Flush the message channel database", __func__);
+
+    messageFlushStats.nFlushes++;
+    messageFlushStats.nLastFlushMicros = GetTimeMicros() - nStart;
+    messageFlushStats.nTotalFlushMicros += messageFlushStats.nLastFlushMicros;
+    messageFlushStats.nLastFlushSize = nSize;
+
+    return true;
+}
+
+bool FlushMessageDatabasesIfNeeded()
+{
+    AssertLockHeld(cs_messaging);
+
+    size_t nSize = GetMessageDirtyCacheSize();
+    if ((int64_t)nSize <= nMessageDirtyCacheLimit)
+        return true;
+
+    LogPrint(BCLog::DB, "%s: Dirty message caches at %.2f MiB, flushing\n", __func__, nSize * (1.0 / 1048576.0));
+    return FlushMessageDatabases();
+}
+
 
 std::string CZMQMessage::createJsonString()
 {
@@ -29,7 +29,29 @@ extern std::set<std::string> setAddressAskedForFalse;
 // Lock for messaging
 extern CCriticalSection cs_messaging;
 
+//! Share of -dbcache (in MiB) the dirty message caches may use before they are flushed on their own
+static const int64_t nMaxMessageDirtyCache = 32;
+static const int64_t nMinMessageDirtyCache = 1;
+
+// Dirty message cache limit in bytes, set from -dbcache at startup
+extern int64_t nMessageDirtyCacheLimit;
+
+struct CMessageFlushStats {
+    uint64_t nFlushes;
+    int64_t nLastFlushMicros;
+    int64_t nTotalFlushMicros;
+    size_t nLastFlushSize;
+
+    CMessageFlushStats() : nFlushes(0), nLastFlushMicros(0), nTotalFlushMicros(0), nLastFlushSize(0) {}
+};
+
 size_t GetMessageDirtyCacheSize();
+CMessageFlushStats GetMessageFlushStats();
+
+// Write the dirty message and channel caches to their databases, cs_messaging must be held
+bool FlushMessageDatabases();
+// Flush the dirty message caches once they grow past nMessageDirtyCacheLimit, cs_messaging must be held
+bool FlushMessageDatabasesIfNeeded();
 bool IsChannelSubscribed(const std::string &name); // Is this channel marked as spamA
 
 bool GetMessage(const COutPoint &out, CMessage &message);
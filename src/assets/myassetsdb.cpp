@@ -2,6 +2,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 #include "validation.h"
+#include "txdb.h"
 #include "myassetsdb.h"
 #include "messages.h"
 #include <boost/thread.hpp>
@@ -11,7 +12,11 @@
 static const char MESSAGE_FLAG = 'Z'; // Message
 static const char MY_MESSAGE_CHANNEL = 'C'; // My followed Channels
 static const char MY_SEEN_ADDRESSES = 'S'; // Addresses that have been seen on the chain
+static const char MY_CHANNEL_SCAN_HEIGHT = 'B'; // Height the message channel scan has processed
 static const char DB_FLAG = 'D'; // Database Flags
+static const char MESSAGE_CHANNEL_INDEX = 'I'; // (Channel, Time, Out) -> Message index
+static const char MESSAGE_EXPIRY_INDEX = 'E'; // (Expire Time, Out) -> Message index
+static const char MESSAGE_CHANNEL_HEAD = 'H'; // Channel -> Newest message in the channel
 
 static const char MY_TAGGED_ADDRESSES = 'T'; // Addresses that have been tagged
 static const char MY_RESTRICTED_ADDRESSES = 'R'; // Addresses that have been restricted
@@ -19,9 +24,53 @@ static const char MY_RESTRICTED_ADDRESSES = 'R'; // Addresses that have been res
 CMessageDB::CMessageDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "messages" / "messages", nCacheSize, fMemory, fWipe) {
 }
 
+static void BatchWriteMessageIndexes(CDBBatch& batch, const CMessage& message)
+{
+    batch.Write(std::make_pair(MESSAGE_CHANNEL_INDEX, CMessageChannelKey(message.strName, message.time, message.out)), '1');
+    if (message.nExpiredTime > 0)
+        batch.Write(std::make_pair(MESSAGE_EXPIRY_INDEX, CMessageExpiryKey(message.nExpiredTime, message.out)), '1');
+}
+
+static void BatchEraseMessageIndexes(CDBBatch& batch, const CMessage& message)
+{
+    batch.Erase(std::make_pair(MESSAGE_CHANNEL_INDEX, CMessageChannelKey(message.strName, message.time, message.out)));
+    if (message.nExpiredTime > 0)
+        batch.Erase(std::make_pair(MESSAGE_EXPIRY_INDEX, CMessageExpiryKey(message.nExpiredTime, message.out)));
+}
+
+void CMessageDB::BatchWriteMessage(CDBBatch& batch, const CMessage& message, std::map<std::string, CMessageChannelHead>& mapHeads)
+{
+    // Messages get rewritten when their status changes, drop the index entries of the stored copy first
+    CMessage stored;
+    if (ReadMessage(message.out, stored))
+        BatchEraseMessageIndexes(batch, stored);
+
+    batch.Write(std::make_pair(MESSAGE_FLAG, message.out), message);
+    BatchWriteMessageIndexes(batch, message);
+
+    // Heads already moved in this batch aren't readable from the database yet
+    auto it = mapHeads.find(message.strName);
+    if (it != mapHeads.end()) {
+        if (it->second.IsOlderThan(message.time, message.out))
+            it->second = CMessageChannelHead(message.time, message.out);
+        return;
+    }
+
+    CMessageChannelHead head;
+    if (!ReadChannelHead(message.strName, head) || head.IsOlderThan(message.time, message.out))
+        mapHeads[message.strName] = CMessageChannelHead(message.time, message.out);
+}
+
 bool CMessageDB::WriteMessage(const CMessage &message)
 {
-    return Write(std::make_pair(MESSAGE_FLAG, message.out), message);
+    CDBBatch batch(*this);
+    std::map<std::string, CMessageChannelHead> mapHeads;
+
+    BatchWriteMessage(batch, message, mapHeads);
+    for (auto head : mapHeads)
+        batch.Write(std::make_pair(MESSAGE_CHANNEL_HEAD, head.first), head.second);
+
+    return WriteBatch(batch);
 }
 
 bool CMessageDB::ReadMessage(const COutPoint &out, CMessage &message)
@@ -31,7 +80,22 @@ bool CMessageDB::ReadMessage(const COutPoint &out, CMessage &message)
 
 bool CMessageDB::EraseMessage(const COutPoint &out)
 {
-    return Erase(std::make_pair(MESSAGE_FLAG, out));
+    CMessage message;
+    if (!ReadMessage(out, message))
+        return Erase(std::make_pair(MESSAGE_FLAG, out));
+
+    CDBBatch batch(*this);
+    batch.Erase(std::make_pair(MESSAGE_FLAG, out));
+    BatchEraseMessageIndexes(batch, message);
+    if (!WriteBatch(batch))
+        return false;
+
+    // Move the channel head back to the newest message left in the channel
+    CMessageChannelHead head;
+    if (ReadChannelHead(message.strName, head) && head.out == out)
+        return UpdateChannelHead(message.strName);
+
+    return true;
 }
 
 bool CMessageDB::LoadMessages(std::set<CMessage>& setMessages)
@@ -63,32 +127,159 @@ bool CMessageDB::LoadMessages(std::set<CMessage>& setMessages)
 bool CMessageDB::EraseAllMessages(int& count)
 {
     std::set<CMessage> setMessages;
+    LoadMessages(setMessages);
+
+    CDBBatch batch(*this);
+    std::set<std::string> setChannels;
+    for (auto message : setMessages) {
+        batch.Erase(std::make_pair(MESSAGE_FLAG, message.out));
+        BatchEraseMessageIndexes(batch, message);
+        setChannels.insert(message.strName);
+    }
+
+    for (auto channel : setChannels)
+        batch.Erase(std::make_pair(MESSAGE_CHANNEL_HEAD, channel));
+
+    count += setMessages.size();
+    return WriteBatch(batch);
+}
+
+bool CMessageDB::ReadChannelHead(const std::string& channel, CMessageChannelHead& head)
+{
+    return Read(std::make_pair(MESSAGE_CHANNEL_HEAD, channel), head);
+}
+
+bool CMessageDB::UpdateChannelHead(const std::string& channel)
+{
     std::unique_ptr<CDBIterator> pcursor(NewIterator());
 
-    pcursor->Seek(std::make_pair(MESSAGE_FLAG, COutPoint()));
+    pcursor->Seek(std::make_pair(MESSAGE_CHANNEL_INDEX, CMessageChannelKey(channel, 0, COutPoint(uint256(), 0))));
 
-    // Load messages
+    bool fFound = false;
+    CMessageChannelHead head;
     while (pcursor->Valid()) {
         boost::this_thread::interruption_point();
-        std::pair<char, COutPoint> key;
-        if (pcursor->GetKey(key) && key.first == MESSAGE_FLAG) {
+        std::pair<char, CMessageChannelKey> key;
+        if (pcursor->GetKey(key) && key.first == MESSAGE_CHANNEL_INDEX && key.second.strChannel == channel) {
+            head = CMessageChannelHead(key.second.nTime, key.second.out);
+            fFound = true;
+            pcursor->Next();
+        } else {
+            break;
+        }
+    }
+
+    if (fFound)
+        return Write(std::make_pair(MESSAGE_CHANNEL_HEAD, channel), head);
+
+    return Erase(std::make_pair(MESSAGE_CHANNEL_HEAD, channel));
+}
+
+bool CMessageDB::LoadMessageChannels(std::vector<std::string>& vChannels)
+{
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(std::make_pair(MESSAGE_CHANNEL_HEAD, std::string()));
+
+    // Every channel with stored messages has exactly one head entry
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char, std::string> key;
+        if (pcursor->GetKey(key) && key.first == MESSAGE_CHANNEL_HEAD) {
+            vChannels.emplace_back(key.second);
+            pcursor->Next();
+        } else {
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool CMessageDB::LoadChannelMessages(const std::string& channel, int64_t nFromTime, int64_t nToTime, size_t nMaxCount, std::vector<CMessage>& vMessages)
+{
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(std::make_pair(MESSAGE_CHANNEL_INDEX, CMessageChannelKey(channel, nFromTime, COutPoint(uint256(), 0))));
+
+    size_t nLoaded = 0;
+    while (pcursor->Valid() && (!nMaxCount || nLoaded < nMaxCount)) {
+        boost::this_thread::interruption_point();
+        std::pair<char, CMessageChannelKey> key;
+        if (pcursor->GetKey(key) && key.first == MESSAGE_CHANNEL_INDEX && key.second.strChannel == channel && key.second.nTime <= nToTime) {
             CMessage message;
-            if (pcursor->GetValue(message)) {
-                setMessages.insert(message);
-                pcursor->Next();
+            if (ReadMessage(key.second.out, message)) {
+                vMessages.emplace_back(message);
+                nLoaded++;
             } else {
-                LogPrintf("%s: failed to read message\n", __func__);
-                pcursor->Next();
+                LogPrintf("%s: failed to read indexed message %s\n", __func__, key.second.out.ToString());
             }
+            pcursor->Next();
         } else {
             break;
         }
     }
 
-    count += setMessages.size();
-    for (auto message : setMessages)
-        EraseMessage(message.out);
+    return true;
+}
+
+bool CMessageDB::EraseExpiredMessages(int64_t nTime, std::vector<COutPoint>& vErased)
+{
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(std::make_pair(MESSAGE_EXPIRY_INDEX, CMessageExpiryKey()));
+
+    // The expiry index is ordered by expire time, so only the expired prefix is walked
+    std::vector<COutPoint> vExpired;
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char, CMessageExpiryKey> key;
+        if (pcursor->GetKey(key) && key.first == MESSAGE_EXPIRY_INDEX && key.second.nExpiredTime <= nTime) {
+            vExpired.emplace_back(key.second.out);
+            pcursor->Next();
+        } else {
+            break;
+        }
+    }
+
+    for (auto out : vExpired) {
+        if (!EraseMessage(out))
+            return error("%s: failed to erase expired message %s", __func__, out.ToString());
+        vErased.emplace_back(out);
+    }
+
+    return true;
+}
 
+bool CMessageDB::BuildMessageIndex()
+{
+    bool fIndexed;
+    if (ReadFlag("channelindex", fIndexed) && fIndexed)
+        return true;
+
+    LogPrintf("%s: Building message channel and expiry indexes\n", __func__);
+
+    std::set<CMessage> setMessages;
+    LoadMessages(setMessages);
+
+    CDBBatch batch(*this);
+    std::map<std::string, CMessageChannelHead> mapHeads;
+    for (auto message : setMessages) {
+        BatchWriteMessageIndexes(batch, message);
+
+        auto it = mapHeads.find(message.strName);
+        if (it == mapHeads.end() || it->second.IsOlderThan(message.time, message.out))
+            mapHeads[message.strName] = CMessageChannelHead(message.time, message.out);
+    }
+
+    for (auto head : mapHeads)
+        batch.Write(std::make_pair(MESSAGE_CHANNEL_HEAD, head.first), head.second);
+
+    batch.Write(std::make_pair(DB_FLAG, std::string("channelindex")), '1');
+    if (!WriteBatch(batch, true))
+        return error("%s: failed to write message indexes", __func__);
+
+    LogPrintf("%s: Indexed %u messages in %u channels\n", __func__, setMessages.size(), mapHeads.size());
     return true;
 }
 
@@ -100,23 +291,55 @@ bool CMessageDB::Flush() {
                 return error("%s: failed to erase message %s", __func__, messageRemove.ToString());
         }
 
-        for (auto messageAdd : mapDirtyMessagesAdd) {
-            if (!WriteMessage(messageAdd.second))
-                return error("%s: failed to write message %s", __func__, messageAdd.second.ToString());
+        CDBBatch batch(*this);
+        std::map<std::string, CMessageChannelHead> mapHeads;
+        size_t batch_size = (size_t)gArgs.GetArg("-dbbatchsize", nDefaultDbBatchSize);
+
+        // Write the batch whenever it grows too large, the heads touched so far are written along with it
+        auto fnWritePartial = [&](bool fForce) {
+            if (!fForce && batch.SizeEstimate() <= batch_size)
+                return true;
+            for (auto head : mapHeads)
+                batch.Write(std::make_pair(MESSAGE_CHANNEL_HEAD, head.first), head.second);
+            LogPrint(BCLog::DB, "%s: Writing batch of %.2f MiB\n", __func__, batch.SizeEstimate() * (1.0 / 1048576.0));
+            bool ret = WriteBatch(batch);
+            batch.Clear();
+            return ret;
+        };
 
+        for (auto messageAdd : mapDirtyMessagesAdd) {
+            BatchWriteMessage(batch, messageAdd.second, mapHeads);
             mapDirtyMessagesOrphaned.erase(messageAdd.first);
+
+            if (!fnWritePartial(false))
+                return error("%s: failed to write message batch", __func__);
         }
 
         for (auto orphans : mapDirtyMessagesOrphaned) {
             CMessage msg = orphans.second;
             msg.status = MessageStatus::ORPHAN;
-            if (!WriteMessage(msg))
-                return error("%s: failed to write message orphan %s", __func__, msg.ToString());
+            BatchWriteMessage(batch, msg, mapHeads);
+
+            if (!fnWritePartial(false))
+                return error("%s: failed to write message orphan batch", __func__);
         }
 
+        if (!fnWritePartial(true))
+            return error("%s: failed to write message batch", __func__);
+
         setDirtyMessagesRemove.clear();
         mapDirtyMessagesAdd.clear();
         mapDirtyMessagesOrphaned.clear();
+
+        // Garbage collect messages whose expire time has passed
+        std::vector<COutPoint> vExpired;
+        if (!EraseExpiredMessages(GetTime(), vExpired))
+            return error("%s: failed to erase expired messages", __func__);
+
+        if (pMessagesCache) {
+            for (auto out : vExpired)
+                pMessagesCache->Erase(out.ToSerializedString());
+        }
     } catch (const std::runtime_error& e) {
         return error("%s : %s ", __func__, std::string("System error while flushing messages: ") + e.what());
     }
@@ -194,6 +417,16 @@ bool CMessageChannelDB::EraseUsedAddress(const std::string& address)
     return Erase(std::make_pair(MY_SEEN_ADDRESSES, address));
 }
 
+bool CMessageChannelDB::WriteScanHeight(int nHeight)
+{
+    return Write(MY_CHANNEL_SCAN_HEIGHT, nHeight);
+}
+
+bool CMessageChannelDB::ReadScanHeight(int& nHeight)
+{
+    return Read(MY_CHANNEL_SCAN_HEIGHT, nHeight);
+}
+
 bool CMessageChannelDB::WriteFlag(const std::string &name, bool fValue)
 {
     return Write(std::make_pair(DB_FLAG, name), fValue ? '1' : '0');
@@ -212,20 +445,19 @@ bool CMessageChannelDB::Flush() {
     try {
         LogPrintf("%s: Flushing messagechannelsdb addSize:%u, removeSize:%u, seenAddressSize:%u\n", __func__, setDirtyChannelsAdd.size(), setDirtyChannelsRemove.size(), setDirtySeenAddressAdd.size());
 
-        for (auto channelRemove : setDirtyChannelsRemove) {
-            if (!EraseMyMessageChannel(channelRemove))
-                return error("%s: failed to erase messagechannel %s", __func__, channelRemove);
-        }
+        CDBBatch batch(*this);
 
-        for (auto channelAdd : setDirtyChannelsAdd) {
-            if (!WriteMyMessageChannel(channelAdd))
-                return error("%s: failed to write messagechannel %s", __func__, channelAdd);
-        }
+        for (auto channelRemove : setDirtyChannelsRemove)
+            batch.Erase(std::make_pair(MY_MESSAGE_CHANNEL, channelRemove));
 
-        for (auto seenAddress : setDirtySeenAddressAdd) {
-            if (!WriteUsedAddress(seenAddress))
-                return error("%s: failed to write seenaddress %s", __func__, seenAddress);
-        }
+        for (auto channelAdd : setDirtyChannelsAdd)
+            batch.Write(std::make_pair(MY_MESSAGE_CHANNEL, channelAdd), 1);
+
+        for (auto seenAddress : setDirtySeenAddressAdd)
+            batch.Write(std::make_pair(MY_SEEN_ADDRESSES, seenAddress), 1);
+
+        if (!WriteBatch(batch))
+            return error("%s: failed to write messagechannel batch", __func__);
 
         setDirtyChannelsRemove.clear();
         setDirtyChannelsAdd.clear();
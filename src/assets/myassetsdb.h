@@ -6,9 +6,73 @@
 #define YOTTAFLUX_MYASSETSDB_H
 
 #include <dbwrapper.h>
+#include <primitives/transaction.h>
 
 class CMessage;
-class COutPoint;
+
+/** Key of the channel index. Times are stored big-endian so LevelDB orders a channel's messages by time */
+struct CMessageChannelKey {
+    std::string strChannel;
+    int64_t nTime;
+    COutPoint out;
+
+    CMessageChannelKey() : nTime(0), out(uint256(), 0) {}
+    CMessageChannelKey(const std::string& strChannelIn, int64_t nTimeIn, const COutPoint& outIn) : strChannel(strChannelIn), nTime(nTimeIn), out(outIn) {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        ::Serialize(s, strChannel);
+        ser_writedata64be(s, (uint64_t)nTime);
+        ::Serialize(s, out);
+    }
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        ::Unserialize(s, strChannel);
+        nTime = (int64_t)ser_readdata64be(s);
+        ::Unserialize(s, out);
+    }
+};
+
+/** Key of the expiry index, ordered by expire time */
+struct CMessageExpiryKey {
+    int64_t nExpiredTime;
+    COutPoint out;
+
+    CMessageExpiryKey() : nExpiredTime(0), out(uint256(), 0) {}
+    CMessageExpiryKey(int64_t nExpiredTimeIn, const COutPoint& outIn) : nExpiredTime(nExpiredTimeIn), out(outIn) {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        ser_writedata64be(s, (uint64_t)nExpiredTime);
+        ::Serialize(s, out);
+    }
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        nExpiredTime = (int64_t)ser_readdata64be(s);
+        ::Unserialize(s, out);
+    }
+};
+
+/** Newest message stored for a channel. One entry exists per channel that has messages */
+struct CMessageChannelHead {
+    int64_t nTime;
+    COutPoint out;
+
+    CMessageChannelHead() : nTime(0) {}
+    CMessageChannelHead(int64_t nTimeIn, const COutPoint& outIn) : nTime(nTimeIn), out(outIn) {}
+
+    bool IsOlderThan(int64_t nOtherTime, const COutPoint& other) const {
+        return nTime < nOtherTime || (nTime == nOtherTime && out < other);
+    }
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(nTime);
+        READWRITE(out);
+    }
+};
 
 class CMessageDB  : public CDBWrapper {
 
@@ -25,11 +89,22 @@ public:
     bool LoadMessages(std::set<CMessage>& setMessages);
     bool EraseAllMessages(int& count);
 
+    // Channel / time / expiry indexes
+    bool ReadChannelHead(const std::string& channel, CMessageChannelHead& head);
+    bool LoadMessageChannels(std::vector<std::string>& vChannels);
+    bool LoadChannelMessages(const std::string& channel, int64_t nFromTime, int64_t nToTime, size_t nMaxCount, std::vector<CMessage>& vMessages);
+    bool EraseExpiredMessages(int64_t nTime, std::vector<COutPoint>& vErased);
+    bool BuildMessageIndex();
+
     // Write / Read Database flags
     bool WriteFlag(const std::string &name, bool fValue);
     bool ReadFlag(const std::string &name, bool &fValue);
 
     bool Flush();
+
+private:
+    void BatchWriteMessage(CDBBatch& batch, const CMessage& message, std::map<std::string, CMessageChannelHead>& mapHeads);
+    bool UpdateChannelHead(const std::string& channel);
 };
 
 class CMessageChannelDB  : public CDBWrapper {
@@ -49,6 +124,10 @@ public:
     bool ReadUsedAddress(const std::string& address);
     bool EraseUsedAddress(const std::string& address);
 
+    // Height the wallet message channel scan has processed up to
+    bool WriteScanHeight(int nHeight);
+    bool ReadScanHeight(int& nHeight);
+
     // Write / Read Database flags
     bool WriteFlag(const std::string &name, bool fValue);
     bool ReadFlag(const std::string &name, bool &fValue);
@@ -214,6 +214,28 @@ bool CRestrictedDB::GetAddressRestrictions(std::string& address, std::vector<std
     return true;
 }
 
+bool CRestrictedDB::ReadAddressRestrictionData(const std::string& address, CAddressRestrictionData& data)
+{
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    for (const char flag : {ADDRESS_QULAIFIER_FLAG, RESTRICTED_ADDRESS_FLAG}) {
+        std::set<std::string>& setNames = flag == ADDRESS_QULAIFIER_FLAG ? data.setQualifiers : data.setRestrictions;
+
+        pcursor->Seek(std::make_pair(flag, std::make_pair(address, std::string())));
+        while (pcursor->Valid()) {
+            std::pair<char, std::pair<std::string, std::string> > key;
+            if (pcursor->GetKey(key) && key.first == flag && key.second.first == address) {
+                setNames.insert(key.second.second);
+                pcursor->Next();
+            } else {
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
 bool CRestrictedDB::GetGlobalRestrictions(std::vector<std::string>& restrictions)
 {
     FlushStateToDisk();
@@ -8,6 +8,8 @@
 
 #include <dbwrapper.h>
 
+struct CAddressRestrictionData;
+
 class CRestrictedDB  : public CDBWrapper {
 
 public:
@@ -52,6 +54,9 @@ public:
 
     bool CheckForAddressRootQualifier(const std::string& address, const std::string& qualifier);
 
+    // Reads every qualifier and restriction of the address in one pass
+    bool ReadAddressRestrictionData(const std::string& address, CAddressRestrictionData& data);
+
     bool Flush();
 };
 
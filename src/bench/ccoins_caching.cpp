@@ -6,8 +6,10 @@
 #include "bench.h"
 #include "coins.h"
 #include "policy/policy.h"
+#include "random.h"
 #include "wallet/crypter.h"
 
+#include <unordered_map>
 #include <vector>
 
 // FIXME: Dedup with SetupDummyInputs in test/transaction_tests.cpp.
@@ -86,3 +88,60 @@ static void CCoinsCaching(benchmark::State& state)
 }
 
 BENCHMARK(CCoinsCaching);
+
+static std::vector<COutPoint> RandomOutpoints(size_t nCount)
+{
+    std::vector<COutPoint> vOutpoints;
+    vOutpoints.reserve(nCount);
+    for (size_t i = 0; i < nCount; i++)
+        vOutpoints.emplace_back(GetRandHash(), i % 4);
+    return vOutpoints;
+}
+
+// Fill a coins map, look every entry up, and erase it all while iterating, the
+// way CCoinsViewCache uses it between two flushes. The std::unordered_map
+// variant is what CCoinsMap used to be, as a baseline.
+template <typename Map>
+static void CoinsMapFillAndErase(benchmark::State& state)
+{
+    const std::vector<COutPoint> vOutpoints = RandomOutpoints(20000);
+    while (state.KeepRunning()) {
+        Map map;
+        for (const COutPoint& outpoint : vOutpoints)
+            map.emplace(std::piecewise_construct, std::forward_as_tuple(outpoint), std::tuple<>());
+        for (const COutPoint& outpoint : vOutpoints)
+            assert(map.find(outpoint) != map.end());
+        for (typename Map::iterator it = map.begin(); it != map.end();)
+            map.erase(it++);
+    }
+}
+
+static void CCoinsMapFillAndErase(benchmark::State& state)
+{
+    CoinsMapFillAndErase<CCoinsMap>(state);
+}
+
+static void CCoinsUnorderedMapFillAndErase(benchmark::State& state)
+{
+    CoinsMapFillAndErase<std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> >(state);
+}
+
+// Flush a cache of 20000 fresh, dirty coins into its parent cache.
+static void CCoinsCachingFlush(benchmark::State& state)
+{
+    const std::vector<COutPoint> vOutpoints = RandomOutpoints(20000);
+    CCoinsView coinsDummy;
+    while (state.KeepRunning()) {
+        CCoinsViewCache coinsParent(&coinsDummy);
+        CCoinsViewCache coins(&coinsParent);
+        for (const COutPoint& outpoint : vOutpoints)
+            coins.AddCoin(outpoint, Coin(CTxOut(CENT, CScript() << OP_TRUE), 1, false), false);
+        bool success = coins.Flush();
+        assert(success);
+        assert(coinsParent.GetCacheSize() == vOutpoints.size());
+    }
+}
+
+BENCHMARK(CCoinsMapFillAndErase);
+BENCHMARK(CCoinsUnorderedMapFillAndErase);
+BENCHMARK(CCoinsCachingFlush);
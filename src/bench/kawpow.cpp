@@ -0,0 +1,133 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "arith_uint256.h"
+#include "chainparams.h"
+#include "fs.h"
+#include "hash.h"
+#include "pow.h"
+#include "primitives/block.h"
+
+#include <crypto/ethash/helpers.hpp>
+#include <crypto/ethash/include/ethash/progpow.hpp>
+#include <crypto/ethash/lib/ethash/ethash-internal.hpp>
+
+static const size_t HEADERS_PER_BATCH = 16;
+
+// Headers in one KAWPOW epoch with a target any hash meets, so every header in a batch is fully checked
+static std::vector<CBlockHeader> CreateKAWPOWHeaders(Consensus::Params& params)
+{
+    params.powLimit = uint256S("ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+
+    std::vector<CBlockHeader> headers(HEADERS_PER_BATCH);
+    for (size_t i = 0; i < headers.size(); i++) {
+        headers[i].nTime = nKAWPOWActivationTime;
+        headers[i].nHeight = 1 + i;
+        headers[i].nNonce64 = i;
+        headers[i].nBits = UintToArith256(params.powLimit).GetCompact();
+        headers[i].GetHashFull(headers[i].mix_hash);
+    }
+    return headers;
+}
+
+// The uint256 <-> ethash::hash256 conversions KAWPOWHash did before, through hex strings
+static void KAWPOWHashConversionHex(benchmark::State& state)
+{
+    uint256 header_hash = uint256S("ffeeddccbbaa9988776655443322110000112233445566778899aabbccddeeff");
+    while (state.KeepRunning()) {
+        const auto hash = to_hash256(header_hash.GetHex());
+        header_hash = uint256S(to_hex(hash));
+    }
+}
+
+// The same conversions done on the bytes
+static void KAWPOWHashConversionBytes(benchmark::State& state)
+{
+    uint256 header_hash = uint256S("ffeeddccbbaa9988776655443322110000112233445566778899aabbccddeeff");
+    while (state.KeepRunning()) {
+        const auto hash = to_hash256(header_hash);
+        header_hash = to_uint256(hash);
+    }
+}
+
+// Headers per second is HEADERS_PER_BATCH times the iterations per second
+static void KAWPOWCheckHeaders(benchmark::State& state)
+{
+    Consensus::Params params = GetParams().GetConsensus();
+    std::vector<CBlockHeader> headers = CreateKAWPOWHeaders(params);
+
+    size_t nFailed;
+    while (state.KeepRunning()) {
+        assert(CheckProofOfWork(headers, params, nFailed));
+    }
+}
+
+// Latency of one light (verification) KAWPOW hash with the given kernel, the AVX2 one falls back
+// to the generic kernel on CPUs without AVX2
+static void KAWPOWLightHash(benchmark::State& state, bool fAVX2)
+{
+    ethash::avx2::set_enabled(fAVX2);
+
+    const ethash::epoch_context& context = ethash::get_global_epoch_context(0);
+    const auto header_hash = to_hash256("ffeeddccbbaa9988776655443322110000112233445566778899aabbccddeeff");
+    uint64_t nonce = 0;
+    while (state.KeepRunning()) {
+        progpow::hash(context, 1, header_hash, nonce++);
+    }
+    ethash::avx2::set_enabled(ethash::avx2::is_supported());
+}
+
+static void KAWPOWLightHashGeneric(benchmark::State& state)
+{
+    KAWPOWLightHash(state, false);
+}
+
+static void KAWPOWLightHashAVX2(benchmark::State& state)
+{
+    KAWPOWLightHash(state, true);
+}
+
+// Building an epoch's light context from scratch, as at startup or an epoch change
+static void KAWPOWCreateEpochContext(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        ethash::create_epoch_context(0);
+    }
+}
+
+// Hashing a header of an epoch whose context is not cached, as when the epoch changes without the next
+// context being prebuilt. Cycles through one epoch more than the global cache holds so every switch misses
+static void KAWPOWEpochSwitch(benchmark::State& state)
+{
+    const auto header_hash = to_hash256("ffeeddccbbaa9988776655443322110000112233445566778899aabbccddeeff");
+    int epoch_number = 0;
+    while (state.KeepRunning()) {
+        const ethash::epoch_context& context = ethash::get_global_epoch_context(epoch_number);
+        progpow::hash(context, epoch_number * ethash::epoch_length, header_hash, 0);
+        epoch_number = (epoch_number + 1) % 4;
+    }
+}
+
+// Loading the same context from a light cache saved by -persistkawpowcache
+static void KAWPOWLoadEpochContext(benchmark::State& state)
+{
+    const fs::path dir = fs::temp_directory_path() / fs::unique_path();
+    fs::create_directories(dir);
+    assert(ethash::save_light_cache(dir.string(), ethash::get_global_epoch_context(0)));
+    while (state.KeepRunning()) {
+        assert(ethash::load_light_cache(dir.string(), 0));
+    }
+    fs::remove_all(dir);
+}
+
+BENCHMARK(KAWPOWHashConversionHex);
+BENCHMARK(KAWPOWHashConversionBytes);
+BENCHMARK(KAWPOWCheckHeaders);
+BENCHMARK(KAWPOWLightHashGeneric);
+BENCHMARK(KAWPOWLightHashAVX2);
+BENCHMARK(KAWPOWCreateEpochContext);
+BENCHMARK(KAWPOWEpochSwitch);
+BENCHMARK(KAWPOWLoadEpochContext);
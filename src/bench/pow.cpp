@@ -0,0 +1,124 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "arith_uint256.h"
+#include "chainparams.h"
+#include "hash.h"
+#include "pow.h"
+#include "primitives/block.h"
+#include "uint256.h"
+
+static const size_t HEADERS_PER_BATCH = 16;
+
+// The Ravencoin genesis block, mined with the same X16R before X16RV2 existed
+static CBlockHeader X16RHeader()
+{
+    CBlockHeader header;
+    header.nVersion = 4;
+    header.hashMerkleRoot = uint256S("28ff00a867739a352523808d301f504bc4547699398d70faf2266a8bae5f3516");
+    header.nTime = 1514999494;
+    header.nBits = 0x1e00ffff;
+    header.nNonce = 25023712;
+    assert(header.GetHash() == uint256S("0000006b444bc2f2ffe627be9d9e7e7a0730000870ef6eb6da46c8eae389df90"));
+    return header;
+}
+
+// Our mainnet genesis block, which is past the X16RV2 activation
+static CBlockHeader X16RV2Header()
+{
+    CBlockHeader header = GetParams().GenesisBlock().GetBlockHeader();
+    assert(header.GetHash() == GetParams().GetConsensus().hashGenesisBlock);
+    return header;
+}
+
+// A fixed header past the KAWPOW activation, with the mix hash of its nonce filled in. Its height is far enough
+// into the chain that the epoch's light cache has a realistic size
+static CBlockHeader KAWPOWHeader()
+{
+    CBlockHeader header;
+    header.nVersion = 0x20000000;
+    header.hashPrevBlock = uint256S("0000006b444bc2f2ffe627be9d9e7e7a0730000870ef6eb6da46c8eae389df90");
+    header.hashMerkleRoot = uint256S("28ff00a867739a352523808d301f504bc4547699398d70faf2266a8bae5f3516");
+    header.nTime = nKAWPOWActivationTime;
+    header.nBits = 0x1e00ffff;
+    header.nHeight = 1219736;
+    header.nNonce64 = 0x49f3d9b1c5d2f1a3;
+    header.GetHashFull(header.mix_hash);
+    return header;
+}
+
+// Latency of one full hash of each era's header, as done when checking a header's proof of work
+static void PoW_X16RHash(benchmark::State& state)
+{
+    const CBlockHeader header = X16RHeader();
+    uint256 mix_hash;
+    while (state.KeepRunning()) {
+        header.GetHashFull(mix_hash);
+    }
+}
+
+static void PoW_X16RV2Hash(benchmark::State& state)
+{
+    const CBlockHeader header = X16RV2Header();
+    uint256 mix_hash;
+    while (state.KeepRunning()) {
+        header.GetHashFull(mix_hash);
+    }
+}
+
+static void PoW_KAWPOWHash(benchmark::State& state)
+{
+    const CBlockHeader header = KAWPOWHeader();
+    uint256 mix_hash;
+    while (state.KeepRunning()) {
+        KAWPOWHash(header, mix_hash);
+    }
+}
+
+// The cheap KAWPOW hash that only checks the final hash against a given mix hash, as GetHash() does
+static void PoW_KAWPOWHashOnlyMix(benchmark::State& state)
+{
+    const CBlockHeader header = KAWPOWHeader();
+    while (state.KeepRunning()) {
+        KAWPOWHash_OnlyMix(header);
+    }
+}
+
+// Checking a batch of headers of one era. Headers per second is HEADERS_PER_BATCH times the iterations per second.
+// KAWPOWCheckHeaders in kawpow.cpp does the same for KAWPOW headers
+static void CheckHeaders(benchmark::State& state, const CBlockHeader& header)
+{
+    Consensus::Params params = GetParams().GetConsensus();
+    params.powLimit = uint256S("ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+
+    std::vector<CBlockHeader> headers(HEADERS_PER_BATCH, header);
+    for (size_t i = 0; i < headers.size(); i++) {
+        headers[i].nBits = UintToArith256(params.powLimit).GetCompact();
+        headers[i].nNonce += i;
+    }
+
+    size_t nFailed;
+    while (state.KeepRunning()) {
+        assert(CheckProofOfWork(headers, params, nFailed));
+    }
+}
+
+static void PoW_X16RCheckHeaders(benchmark::State& state)
+{
+    CheckHeaders(state, X16RHeader());
+}
+
+static void PoW_X16RV2CheckHeaders(benchmark::State& state)
+{
+    CheckHeaders(state, X16RV2Header());
+}
+
+BENCHMARK(PoW_X16RHash);
+BENCHMARK(PoW_X16RV2Hash);
+BENCHMARK(PoW_KAWPOWHash);
+BENCHMARK(PoW_KAWPOWHashOnlyMix);
+BENCHMARK(PoW_X16RCheckHeaders);
+BENCHMARK(PoW_X16RV2CheckHeaders);
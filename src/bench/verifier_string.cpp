@@ -0,0 +1,48 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "LibBoolEE.h"
+
+#include <string>
+
+// A deeply nested verifier close to the 80 character limit, as stored after stripping
+static const std::string DEEP_VERIFIER = "((((KYC&!BAN)|(AML&US))&(((A|B)&!C)|(D&(E|F))))|!((G&H)|(I&!J)))&(K|(L&!M))";
+
+static void VerifierStringResolve(benchmark::State& state)
+{
+    LibBoolEE::Vals vals;
+    LibBoolEE::Program program;
+    LibBoolEE::compile(DEEP_VERIFIER, program);
+    for (size_t i = 0; i < program.vars.size(); i++)
+        vals.insert(std::make_pair(program.vars[i], i % 3 != 0));
+
+    while (state.KeepRunning()) {
+        LibBoolEE::resolve(DEEP_VERIFIER, vals);
+    }
+}
+
+static void VerifierStringCompile(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        LibBoolEE::Program program;
+        LibBoolEE::compile(DEEP_VERIFIER, program);
+    }
+}
+
+static void VerifierStringEvaluate(benchmark::State& state)
+{
+    LibBoolEE::Program program;
+    LibBoolEE::compile(DEEP_VERIFIER, program);
+
+    uint64_t values = 0;
+    while (state.KeepRunning()) {
+        program.evaluate(values++);
+    }
+}
+
+BENCHMARK(VerifierStringResolve);
+BENCHMARK(VerifierStringCompile);
+BENCHMARK(VerifierStringEvaluate);
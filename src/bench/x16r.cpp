@@ -0,0 +1,95 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "hash.h"
+#include "uint256.h"
+
+/* Number of 64-byte chain links hashed per iteration */
+static const int HASHES_PER_ITERATION = 1000;
+
+// One benchmark per X16R building block, hashing 64 bytes at a time like every link of the chain after the first
+#define X16R_ALGO_BENCH(name, ctx_type, algo)                                   \
+    static void X16R_##name(benchmark::State& state)                            \
+    {                                                                           \
+        uint512 hash;                                                           \
+        ctx_type ctx;                                                           \
+        while (state.KeepRunning()) {                                           \
+            for (int i = 0; i < HASHES_PER_ITERATION; i++) {                    \
+                algo##_init(&ctx);                                              \
+                algo(&ctx, hash.begin(), hash.size());                          \
+                algo##_close(&ctx, hash.begin());                               \
+            }                                                                   \
+        }                                                                       \
+    }                                                                           \
+    BENCHMARK(X16R_##name);
+
+X16R_ALGO_BENCH(Blake512, sph_blake512_context, sph_blake512)
+X16R_ALGO_BENCH(BMW512, sph_bmw512_context, sph_bmw512)
+X16R_ALGO_BENCH(Groestl512, sph_groestl512_context, sph_groestl512)
+X16R_ALGO_BENCH(JH512, sph_jh512_context, sph_jh512)
+X16R_ALGO_BENCH(Keccak512, sph_keccak512_context, sph_keccak512)
+X16R_ALGO_BENCH(Skein512, sph_skein512_context, sph_skein512)
+X16R_ALGO_BENCH(Luffa512, sph_luffa512_context, sph_luffa512)
+X16R_ALGO_BENCH(CubeHash512, sph_cubehash512_context, sph_cubehash512)
+X16R_ALGO_BENCH(SHAvite512, sph_shavite512_context, sph_shavite512)
+X16R_ALGO_BENCH(SIMD512, sph_simd512_context, sph_simd512)
+X16R_ALGO_BENCH(Echo512, sph_echo512_context, sph_echo512)
+X16R_ALGO_BENCH(Hamsi512, sph_hamsi512_context, sph_hamsi512)
+X16R_ALGO_BENCH(Fugue512, sph_fugue512_context, sph_fugue512)
+X16R_ALGO_BENCH(Shabal512, sph_shabal512_context, sph_shabal512)
+X16R_ALGO_BENCH(Whirlpool, sph_whirlpool_context, sph_whirlpool)
+X16R_ALGO_BENCH(SHA512, sph_sha512_context, sph_sha512)
+X16R_ALGO_BENCH(Tiger, sph_tiger_context, sph_tiger)
+
+// The AES-based functions again, on the portable code
+static void X16R_SHAvite512Generic(benchmark::State& state)
+{
+    sph_shavite512_set_aesni(0);
+    X16R_SHAvite512(state);
+    sph_shavite512_set_aesni(1);
+}
+
+static void X16R_Echo512Generic(benchmark::State& state)
+{
+    sph_echo512_set_aesni(0);
+    X16R_Echo512(state);
+    sph_echo512_set_aesni(1);
+}
+
+// Full 80-byte header hashes, cycling the previous block hash so every algorithm order is exercised
+static void HashHeaders(benchmark::State& state, bool fV2)
+{
+    std::vector<unsigned char> header(80, 0);
+    uint256 hashPrev = uint256S("19bcdaa780349350b210ca84d73dc1c08fbae659990b47a9d28655e7e9be3970");
+    while (state.KeepRunning()) {
+        hashPrev = fV2 ? HashX16RV2(header.begin(), header.end(), hashPrev) : HashX16R(header.begin(), header.end(), hashPrev);
+    }
+}
+
+static void X16R_Header(benchmark::State& state)
+{
+    HashHeaders(state, false);
+}
+
+static void X16RV2_Header(benchmark::State& state)
+{
+    HashHeaders(state, true);
+}
+
+static void X16R_HeaderGeneric(benchmark::State& state)
+{
+    sph_echo512_set_aesni(0);
+    sph_shavite512_set_aesni(0);
+    HashHeaders(state, false);
+    sph_echo512_set_aesni(1);
+    sph_shavite512_set_aesni(1);
+}
+
+BENCHMARK(X16R_SHAvite512Generic);
+BENCHMARK(X16R_Echo512Generic);
+BENCHMARK(X16R_Header);
+BENCHMARK(X16RV2_Header);
+BENCHMARK(X16R_HeaderGeneric);
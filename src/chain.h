@@ -305,6 +305,8 @@ public:
         block.nHeight        = nHeight;
         block.nNonce64       = nNonce64;
         block.mix_hash       = mix_hash;
+        if (phashBlock)
+            block.MemoizeHash(*phashBlock);
         return block;
     }
 
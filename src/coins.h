@@ -10,6 +10,7 @@
 #include "primitives/transaction.h"
 #include "compressor.h"
 #include "core_memusage.h"
+#include "flathashmap.h"
 #include "hash.h"
 #include "memusage.h"
 #include "serialize.h"
@@ -91,8 +92,8 @@ public:
 class SaltedOutpointHasher
 {
 private:
-    /** Salt */
-    const uint64_t k0, k1;
+    /** Salt, not const so that maps using the hasher can be swapped */
+    uint64_t k0, k1;
 
 public:
     SaltedOutpointHasher();
@@ -126,7 +127,7 @@ struct CCoinsCacheEntry
     explicit CCoinsCacheEntry(Coin&& coin_) : coin(std::move(coin_)), flags(0) {}
 };
 
-typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> CCoinsMap;
+typedef flathashmap<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> CCoinsMap;
 
 /** Cursor for iterating over CoinsView state */
 class CCoinsViewCursor
@@ -0,0 +1,165 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "coinsflusher.h"
+
+#include "memusage.h"
+#include "txdb.h"
+#include "util.h"
+#include "utiltime.h"
+
+#include <functional>
+
+CCoinsViewFlusher::CCoinsViewFlusher(CCoinsViewDB *dbIn, bool fBackground) : CCoinsViewBacked(dbIn), db(dbIn), nFrozenUsage(0), fWriteFailed(false), fQuit(false)
+{
+    if (fBackground)
+        thread = std::thread(&TraceThread<std::function<void()> >, "coinsflush", std::function<void()>(std::bind(&CCoinsViewFlusher::ThreadFlush, this)));
+}
+
+CCoinsViewFlusher::~CCoinsViewFlusher()
+{
+    Sync();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        fQuit = true;
+        condWriter.notify_all();
+    }
+    if (thread.joinable())
+        thread.join();
+}
+
+void CCoinsViewFlusher::ThreadFlush()
+{
+    while (true) {
+        const CCoinsMap* pmap;
+        uint256 hashBlock;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condWriter.wait(lock, [this] { return fQuit || pfrozen; });
+            if (!pfrozen)
+                return;
+            pmap = pfrozen.get();
+            hashBlock = hashFrozen;
+        }
+
+        // Nothing changes the frozen map until it is dropped below, so it can be read without the lock
+        size_t nUsage = memusage::DynamicUsage(*pmap);
+        for (const auto& entry : *pmap)
+            nUsage += entry.second.coin.DynamicMemoryUsage();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            nFrozenUsage = nUsage;
+        }
+
+        int64_t nTimeStart = GetTimeMicros();
+        bool fOk;
+        try {
+            fOk = db->WriteCoins(*pmap, hashBlock);
+        } catch (const std::exception& e) {
+            LogPrintf("Error writing to coin database: %s\n", e.what());
+            fOk = false;
+        }
+        LogPrint(BCLog::COINDB, "Wrote %u cached coins in the background in %.2fs\n", (unsigned int)pmap->size(), (GetTimeMicros() - nTimeStart) * 0.000001);
+
+        std::unique_ptr<CCoinsMap> pwritten;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!fOk)
+                fWriteFailed = true;
+            pwritten = std::move(pfrozen);
+            nFrozenUsage = 0;
+            condWritten.notify_all();
+        }
+        // Freeing a large map takes a while, do it without blocking readers
+        pwritten.reset();
+    }
+}
+
+bool CCoinsViewFlusher::GetCoin(const COutPoint &outpoint, Coin &coin) const
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pfrozen) {
+            CCoinsMap::const_iterator it = pfrozen->find(outpoint);
+            if (it != pfrozen->end()) {
+                if (it->second.coin.IsSpent())
+                    return false;
+                coin = it->second.coin;
+                return true;
+            }
+        }
+    }
+    return base->GetCoin(outpoint, coin);
+}
+
+bool CCoinsViewFlusher::HaveCoin(const COutPoint &outpoint) const
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pfrozen) {
+            CCoinsMap::const_iterator it = pfrozen->find(outpoint);
+            if (it != pfrozen->end())
+                return !it->second.coin.IsSpent();
+        }
+    }
+    return base->HaveCoin(outpoint);
+}
+
+uint256 CCoinsViewFlusher::GetBestBlock() const
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pfrozen)
+            return hashFrozen;
+    }
+    return base->GetBestBlock();
+}
+
+bool CCoinsViewFlusher::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock)
+{
+    if (!thread.joinable())
+        return base->BatchWrite(mapCoins, hashBlock);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (pfrozen) {
+        LogPrint(BCLog::COINDB, "Waiting for the previous flush to be written\n");
+        condWritten.wait(lock, [this] { return !pfrozen; });
+    }
+    if (fWriteFailed)
+        return false;
+
+    // Until the writer has counted it, the map without the scripts will do as an estimate of its memory
+    pfrozen.reset(new CCoinsMap());
+    pfrozen->swap(mapCoins);
+    hashFrozen = hashBlock;
+    nFrozenUsage = memusage::DynamicUsage(*pfrozen);
+    condWriter.notify_one();
+    return true;
+}
+
+CCoinsViewCursor *CCoinsViewFlusher::Cursor() const
+{
+    // The cursor iterates over the database, which must have every coin first
+    Sync();
+    return base->Cursor();
+}
+
+bool CCoinsViewFlusher::Sync() const
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    condWritten.wait(lock, [this] { return !pfrozen; });
+    return !fWriteFailed;
+}
+
+bool CCoinsViewFlusher::HasWriteFailed() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return fWriteFailed;
+}
+
+size_t CCoinsViewFlusher::DynamicMemoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return pfrozen ? nFrozenUsage : 0;
+}
@@ -0,0 +1,73 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef YOTTAFLUX_COINSFLUSHER_H
+#define YOTTAFLUX_COINSFLUSHER_H
+
+#include "coins.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+class CCoinsViewDB;
+
+/** Default for -backgroundflush */
+static const bool DEFAULT_BACKGROUND_FLUSH = true;
+
+/**
+ * A layer directly on top of the coins database that writes flushes on a background thread.
+ *
+ * BatchWrite swaps the flushed entries into a frozen map and returns straight away, so that validation can go on
+ * with a fresh, empty cache while the frozen map is written out. Until the write is done, reads of the frozen entries
+ * are answered from it rather than from the database, which does not have them yet. Only one flush is written at a
+ * time: a second one waits for the first to finish.
+ *
+ * The database is written exactly as with a foreground flush, so a crash in the middle of a background write leaves
+ * it with the head blocks marker of that flush, and ReplayBlocks finishes the job on the next start.
+ */
+class CCoinsViewFlusher : public CCoinsViewBacked
+{
+private:
+    CCoinsViewDB *db;
+
+    mutable std::mutex mutex;
+    //! The writer waits on this for a flush to write
+    std::condition_variable condWriter;
+    //! BatchWrite and Sync wait on this for the write in progress to finish
+    mutable std::condition_variable condWritten;
+
+    //! Entries being written, and the block they bring the database to, if a write is in progress
+    std::unique_ptr<CCoinsMap> pfrozen;
+    uint256 hashFrozen;
+    size_t nFrozenUsage;
+    bool fWriteFailed;
+    bool fQuit;
+
+    std::thread thread;
+
+    void ThreadFlush();
+
+public:
+    CCoinsViewFlusher(CCoinsViewDB *dbIn, bool fBackground);
+    ~CCoinsViewFlusher();
+
+    bool GetCoin(const COutPoint &outpoint, Coin &coin) const override;
+    bool HaveCoin(const COutPoint &outpoint) const override;
+    uint256 GetBestBlock() const override;
+    bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
+    CCoinsViewCursor *Cursor() const override;
+
+    /** Wait for the write in progress, if any, to finish. Returns false if a background write has failed */
+    bool Sync() const;
+
+    /** Whether a background write has failed, after which the database no longer matches the chain state */
+    bool HasWriteFailed() const;
+
+    /** Memory held by the entries being written */
+    size_t DynamicMemoryUsage() const;
+};
+
+#endif // YOTTAFLUX_COINSFLUSHER_H
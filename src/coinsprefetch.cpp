@@ -0,0 +1,156 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "coinsprefetch.h"
+
+#include "primitives/block.h"
+#include "util.h"
+
+#include <functional>
+#include <set>
+
+CCoinsViewPrefetch::CCoinsViewPrefetch(CCoinsView *viewIn, int nThreads) : CCoinsViewBacked(viewIn), nWrites(0), fQuit(false)
+{
+    for (int i = 0; i < nThreads; i++)
+        threads.emplace_back(&TraceThread<std::function<void()> >, "coinsprefetch", std::function<void()>(std::bind(&CCoinsViewPrefetch::ThreadPrefetch, this)));
+}
+
+CCoinsViewPrefetch::~CCoinsViewPrefetch()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        fQuit = true;
+        condWorker.notify_all();
+        condRead.notify_all();
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+void CCoinsViewPrefetch::ThreadPrefetch()
+{
+    while (true) {
+        COutPoint outpoint;
+        uint64_t nWritesBefore;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condWorker.wait(lock, [this] { return fQuit || !queue.empty(); });
+            if (fQuit)
+                return;
+            outpoint = queue.front();
+            queue.pop_front();
+
+            // GetCoin may have taken the outpoint over, or a flush dropped it
+            auto it = mapStaged.find(outpoint);
+            if (it == mapStaged.end() || it->second.state != State::QUEUED)
+                continue;
+            it->second.state = State::READING;
+            nWritesBefore = nWrites;
+        }
+
+        Coin coin;
+        bool fFound = base->GetCoin(outpoint, coin);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (nWrites == nWritesBefore) {
+            auto it = mapStaged.find(outpoint);
+            if (it != mapStaged.end() && it->second.state == State::READING) {
+                it->second.state = fFound ? State::FOUND : State::MISSING;
+                it->second.coin = std::move(coin);
+            }
+        }
+        condRead.notify_all();
+    }
+}
+
+bool CCoinsViewPrefetch::GetCoin(const COutPoint &outpoint, Coin &coin) const
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto it = mapStaged.find(outpoint);
+        if (it != mapStaged.end()) {
+            // A read already under way is quicker to wait for than to repeat, one still queued is read right here
+            condRead.wait(lock, [&] {
+                it = mapStaged.find(outpoint);
+                return fQuit || it == mapStaged.end() || it->second.state != State::READING;
+            });
+            if (it != mapStaged.end()) {
+                bool fFound = it->second.state == State::FOUND;
+                bool fRead = fFound || it->second.state == State::MISSING;
+                if (fFound)
+                    coin = std::move(it->second.coin);
+                mapStaged.erase(it);
+                if (fRead)
+                    return fFound;
+            }
+        }
+    }
+    return base->GetCoin(outpoint, coin);
+}
+
+bool CCoinsViewPrefetch::HaveCoin(const COutPoint &outpoint) const
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = mapStaged.find(outpoint);
+        if (it != mapStaged.end() && it->second.state == State::FOUND)
+            return true;
+        if (it != mapStaged.end() && it->second.state == State::MISSING)
+            return false;
+    }
+    return base->HaveCoin(outpoint);
+}
+
+bool CCoinsViewPrefetch::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock)
+{
+    bool fOk = base->BatchWrite(mapCoins, hashBlock);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    nWrites++;
+    mapStaged.clear();
+    queue.clear();
+    condRead.notify_all();
+    return fOk;
+}
+
+void CCoinsViewPrefetch::PrefetchBlock(const CBlock& block, const CCoinsViewCache* pcache)
+{
+    if (threads.empty())
+        return;
+
+    std::set<uint256> setBlockTxids;
+    for (const CTransactionRef& tx : block.vtx)
+        setBlockTxids.insert(tx->GetHash());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (unsigned int i = 1; i < block.vtx.size(); i++) {
+        for (const CTxIn& txin : block.vtx[i]->vin) {
+            if (mapStaged.size() >= MAX_PREFETCH_COINS)
+                break;
+            if (setBlockTxids.count(txin.prevout.hash) || (pcache && pcache->HaveCoinInCache(txin.prevout)))
+                continue;
+            if (mapStaged.emplace(txin.prevout, StagedCoin()).second)
+                queue.push_back(txin.prevout);
+        }
+    }
+    condWorker.notify_all();
+}
+
+void CCoinsViewPrefetch::ForgetBlock(const CBlock& block)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (unsigned int i = 1; i < block.vtx.size(); i++) {
+        for (const CTxIn& txin : block.vtx[i]->vin) {
+            auto it = mapStaged.find(txin.prevout);
+            if (it != mapStaged.end() && it->second.state != State::READING)
+                mapStaged.erase(it);
+        }
+    }
+}
+
+size_t CCoinsViewPrefetch::StagedCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return mapStaged.size();
+}
@@ -0,0 +1,89 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef YOTTAFLUX_COINSPREFETCH_H
+#define YOTTAFLUX_COINSPREFETCH_H
+
+#include "coins.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class CBlock;
+
+/** Default for -prefetchthreads, the number of threads reading block inputs from the coins database ahead of time */
+static const int DEFAULT_PREFETCH_THREADS = 4;
+/** Maximum number of prefetch threads */
+static const int MAX_PREFETCH_THREADS = 16;
+/** Maximum number of coins staged at once, so that blocks far ahead of the tip cannot use up memory */
+static const size_t MAX_PREFETCH_COINS = 100000;
+
+/**
+ * A layer between the chain state cache and the coins database that reads the inputs of blocks from the database on
+ * worker threads before ConnectBlock asks for them, so that connecting a block with a cold cache waits on a handful
+ * of parallel reads rather than one read per input in turn.
+ *
+ * Staged coins are a copy of what the database held when they were read, so they are dropped whenever the cache is
+ * flushed into the database, and a read that was in flight across a flush is discarded. Above this layer the cache
+ * sees exactly what it would have read from the database itself.
+ */
+class CCoinsViewPrefetch : public CCoinsViewBacked
+{
+private:
+    enum class State {
+        QUEUED,     //!< waiting for a worker
+        READING,    //!< being read by a worker
+        FOUND,      //!< read, and the coin is unspent
+        MISSING,    //!< read, and there is no such unspent coin
+    };
+
+    struct StagedCoin {
+        State state;
+        Coin coin;
+
+        StagedCoin() : state(State::QUEUED) {}
+    };
+
+    mutable std::mutex mutex;
+    //! Workers wait on this for outpoints to read
+    std::condition_variable condWorker;
+    //! GetCoin waits on this for an outpoint a worker is reading
+    mutable std::condition_variable condRead;
+
+    mutable std::unordered_map<COutPoint, StagedCoin, SaltedOutpointHasher> mapStaged;
+    std::deque<COutPoint> queue;
+    //! Incremented on every write to the database, so that reads from before it are not staged
+    uint64_t nWrites;
+    bool fQuit;
+
+    std::vector<std::thread> threads;
+
+    void ThreadPrefetch();
+
+public:
+    CCoinsViewPrefetch(CCoinsView *viewIn, int nThreads);
+    ~CCoinsViewPrefetch();
+
+    bool GetCoin(const COutPoint &outpoint, Coin &coin) const override;
+    bool HaveCoin(const COutPoint &outpoint) const override;
+    bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
+
+    /**
+     * Start reading the coins spent by a block. Inputs that spend outputs of the block itself, and inputs already in
+     * pcache if one is given, are skipped. The caller must hold the lock guarding pcache.
+     */
+    void PrefetchBlock(const CBlock& block, const CCoinsViewCache* pcache = nullptr);
+
+    /** Drop whatever is still staged for a block's inputs once it has been connected (or failed to) */
+    void ForgetBlock(const CBlock& block);
+
+    /** Number of outpoints queued, being read or staged */
+    size_t StagedCount() const;
+};
+
+#endif // YOTTAFLUX_COINSPREFETCH_H
@@ -108,6 +108,17 @@ void ethash_destroy_epoch_context_full(struct ethash_epoch_context_full* context
  */
 const struct ethash_epoch_context* ethash_get_global_epoch_context(int epoch_number) NOEXCEPT;
 
+/**
+ * Start building the global shared epoch context in the background, if it isn't cached already.
+ */
+void ethash_prebuild_global_epoch_context(int epoch_number) NOEXCEPT;
+
+/**
+ * Save the light caches of the global shared epoch contexts to the existing directory dir, and load
+ * them from there instead of building them again. An empty dir (the default) disables this.
+ */
+void ethash_set_global_light_cache_dir(const char* dir) NOEXCEPT;
+
 /**
  * Get global shared epoch context with full dataset initialized.
  */
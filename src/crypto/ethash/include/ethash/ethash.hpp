@@ -164,6 +164,18 @@ inline const epoch_context& get_global_epoch_context(int epoch_number) noexcept
     return *ethash_get_global_epoch_context(epoch_number);
 }
 
+/// Start building the global shared epoch context in the background, so it is ready before it is needed.
+inline void prebuild_global_epoch_context(int epoch_number) noexcept
+{
+    ethash_prebuild_global_epoch_context(epoch_number);
+}
+
+/// Save the light caches of the global shared epoch contexts to dir and load them from there.
+inline void set_global_light_cache_dir(const char* dir) noexcept
+{
+    ethash_set_global_light_cache_dir(dir);
+}
+
 /// Get global shared epoch context with full dataset initialized.
 inline const epoch_context_full& get_global_epoch_context_full(int epoch_number) noexcept
 {
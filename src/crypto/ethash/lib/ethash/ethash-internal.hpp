@@ -12,9 +12,17 @@
 
 #include "endianness.hpp"
 
+#include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 
+/// The AVX2 kernels are built on x86-64 with compilers supporting per-function target attributes,
+/// and only used when the CPU supports AVX2 (see ethash::avx2::is_supported()).
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define ETHASH_AVX2 1
+#endif
+
 extern "C" struct ethash_epoch_context_full : ethash_epoch_context
 {
     ethash_hash1024* full_dataset;
@@ -52,6 +60,10 @@ hash512 calculate_dataset_item_512(const epoch_context& context, int64_t index)
 hash1024 calculate_dataset_item_1024(const epoch_context& context, uint32_t index) noexcept;
 hash2048 calculate_dataset_item_2048(const epoch_context& context, uint32_t index) noexcept;
 
+/// Fills a light cache of num_items items for the epoch with the given seed, e.g. from a copy
+/// saved earlier, instead of building it. Returns false if it cannot.
+using load_light_cache_fn = std::function<bool(hash512 cache[], int num_items, const hash256& seed)>;
+
 namespace generic
 {
 using hash_fn_512 = hash512 (*)(const uint8_t* data, size_t size);
@@ -63,6 +75,36 @@ void build_light_cache(
 epoch_context_full* create_epoch_context(
     build_light_cache_fn build_fn, int epoch_number, bool full) noexcept;
 
+hash2048 calculate_dataset_item_2048(const epoch_context& context, uint32_t index) noexcept;
+
+/// Creates a light epoch context with its light cache filled by load_fn. Returns null if load_fn
+/// fails.
+epoch_context_ptr create_epoch_context(int epoch_number, const load_light_cache_fn& load_fn) noexcept;
+
 }  // namespace generic
 
+/// Saves the light cache of a context to dir, to be read back by load_light_cache().
+bool save_light_cache(const std::string& dir, const epoch_context& context) noexcept;
+
+/// Creates a light epoch context from the light cache saved in dir. Returns null if there is none,
+/// or if it is not a complete and valid light cache for the epoch.
+epoch_context_ptr load_light_cache(const std::string& dir, int epoch_number) noexcept;
+
+namespace avx2
+{
+/// Whether this build has the AVX2 kernels and the CPU can run them.
+bool is_supported() noexcept;
+
+/// Whether the AVX2 kernels are used by calculate_dataset_item_2048() and ProgPoW hashing.
+/// They are enabled by default when supported.
+bool is_enabled() noexcept;
+
+/// Enables or disables the AVX2 kernels. Returns false if enabling them is not supported.
+/// Both kernels give bit-identical results, this is meant for tests and benchmarks.
+bool set_enabled(bool enabled) noexcept;
+
+hash2048 calculate_dataset_item_2048(const epoch_context& context, uint32_t index) noexcept;
+
+}  // namespace avx2
+
 }  // namespace ethash
@@ -11,11 +11,16 @@
 #include <crypto/ethash/include/ethash/keccak.hpp>
 #include <crypto/ethash/include/ethash/progpow.hpp>
 
+#include <atomic>
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
 #include <limits>
 
+#if ETHASH_AVX2
+#include <immintrin.h>
+#endif
+
 namespace ethash
 {
 // Internal constants:
@@ -128,8 +133,10 @@ void build_light_cache(
     }
 }
 
-epoch_context_full* create_epoch_context(
-    build_light_cache_fn build_fn, int epoch_number, bool full) noexcept
+namespace
+{
+epoch_context_full* create_epoch_context_with(
+    const load_light_cache_fn& fill_fn, int epoch_number, bool full) noexcept
 {
     static_assert(sizeof(epoch_context_full) < sizeof(hash512), "epoch_context too big");
     static constexpr size_t context_alloc_size = sizeof(hash512);
@@ -149,7 +156,11 @@ epoch_context_full* create_epoch_context(
 
     hash512* const light_cache = reinterpret_cast<hash512*>(alloc_data + context_alloc_size);
     const hash256 epoch_seed = calculate_epoch_seed(epoch_number);
-    build_fn(light_cache, light_cache_num_items, epoch_seed);
+    if (!fill_fn(light_cache, light_cache_num_items, epoch_seed))
+    {
+        std::free(alloc_data);
+        return nullptr;
+    }
 
     uint32_t* const l1_cache =
         reinterpret_cast<uint32_t*>(alloc_data + context_alloc_size + light_cache_size);
@@ -170,6 +181,23 @@ epoch_context_full* create_epoch_context(
         full_dataset_2048[i] = calculate_dataset_item_2048(*context, i);
     return context;
 }
+}  // namespace
+
+epoch_context_full* create_epoch_context(
+    build_light_cache_fn build_fn, int epoch_number, bool full) noexcept
+{
+    return create_epoch_context_with(
+        [build_fn](hash512 cache[], int num_items, const hash256& seed) {
+            build_fn(cache, num_items, seed);
+            return true;
+        },
+        epoch_number, full);
+}
+
+epoch_context_ptr create_epoch_context(int epoch_number, const load_light_cache_fn& load_fn) noexcept
+{
+    return {create_epoch_context_with(load_fn, epoch_number, false), ethash_destroy_epoch_context};
+}
 }  // namespace generic
 
 void build_light_cache(hash512 cache[], int num_items, const hash256& seed) noexcept
@@ -232,6 +260,8 @@ hash1024 calculate_dataset_item_1024(const epoch_context& context, uint32_t inde
     return hash1024{{item0.final(), item1.final()}};
 }
 
+namespace generic
+{
 hash2048 calculate_dataset_item_2048(const epoch_context& context, uint32_t index) noexcept
 {
     item_state item0{context, int64_t(index) * 4};
@@ -249,6 +279,116 @@ hash2048 calculate_dataset_item_2048(const epoch_context& context, uint32_t inde
 
     return hash2048{{item0.final(), item1.final(), item2.final(), item3.final()}};
 }
+}  // namespace generic
+
+namespace avx2
+{
+namespace
+{
+bool detect() noexcept
+{
+#if ETHASH_AVX2
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+std::atomic<bool>& enabled_flag() noexcept
+{
+    static std::atomic<bool> enabled{is_supported()};
+    return enabled;
+}
+}  // namespace
+
+bool is_supported() noexcept
+{
+    static const bool supported = detect();
+    return supported;
+}
+
+bool is_enabled() noexcept
+{
+    return enabled_flag().load(std::memory_order_relaxed);
+}
+
+bool set_enabled(bool enabled) noexcept
+{
+    if (enabled && !is_supported())
+        return false;
+    enabled_flag().store(enabled, std::memory_order_relaxed);
+    return true;
+}
+
+#if ETHASH_AVX2
+/// The same as generic::calculate_dataset_item_2048(), with each item's 16-word mix held in
+/// two AVX2 registers so that the FNV step with the parent item is two multiplies and two xors.
+__attribute__((target("avx2")))
+hash2048 calculate_dataset_item_2048(const epoch_context& context, uint32_t index) noexcept
+{
+    static constexpr size_t num_items = 4;
+    static constexpr size_t num_words = sizeof(hash512) / sizeof(uint32_t);
+
+    const hash512* const cache = context.light_cache;
+    const int64_t num_cache_items = context.light_cache_num_items;
+    const __m256i prime = _mm256_set1_epi32(static_cast<int>(fnv_prime));
+
+    uint32_t seeds[num_items];
+    __m256i mix[num_items][2];
+    for (size_t k = 0; k < num_items; ++k)
+    {
+        const int64_t item_index = int64_t(index) * num_items + int64_t(k);
+        seeds[k] = static_cast<uint32_t>(item_index);
+
+        hash512 init = cache[item_index % num_cache_items];
+        init.word32s[0] ^= le::uint32(seeds[k]);
+        init = le::uint32s(keccak512(init));
+        mix[k][0] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&init.word32s[0]));
+        mix[k][1] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&init.word32s[8]));
+    }
+
+    for (uint32_t j = 0; j < full_dataset_item_parents; ++j)
+    {
+        const uint32_t w = j % num_words;
+        const __m256i word_index = _mm256_set1_epi32(static_cast<int>(w % 8));
+        for (size_t k = 0; k < num_items; ++k)
+        {
+            const uint32_t word = static_cast<uint32_t>(
+                _mm256_cvtsi256_si32(_mm256_permutevar8x32_epi32(mix[k][w / 8], word_index)));
+            const uint32_t t = fnv1(seeds[k] ^ j, word);
+            const hash512& parent = cache[t % num_cache_items];
+            mix[k][0] = _mm256_xor_si256(_mm256_mullo_epi32(mix[k][0], prime),
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&parent.word32s[0])));
+            mix[k][1] = _mm256_xor_si256(_mm256_mullo_epi32(mix[k][1], prime),
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&parent.word32s[8])));
+        }
+    }
+
+    hash2048 item;
+    for (size_t k = 0; k < num_items; ++k)
+    {
+        hash512 final_mix;
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&final_mix.word32s[0]), mix[k][0]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&final_mix.word32s[8]), mix[k][1]);
+        item.hash512s[k] = keccak512(final_mix);
+    }
+    return item;
+}
+#else
+hash2048 calculate_dataset_item_2048(const epoch_context& context, uint32_t index) noexcept
+{
+    return generic::calculate_dataset_item_2048(context, index);
+}
+#endif
+}  // namespace avx2
+
+hash2048 calculate_dataset_item_2048(const epoch_context& context, uint32_t index) noexcept
+{
+    if (avx2::is_enabled())
+        return avx2::calculate_dataset_item_2048(context, index);
+    return generic::calculate_dataset_item_2048(context, index);
+}
 
 namespace
 {
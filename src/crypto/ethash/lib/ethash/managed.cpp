@@ -3,9 +3,20 @@
 // Licensed under the Apache License, Version 2.0.
 
 #include "crypto/ethash/lib/ethash/ethash-internal.hpp"
+#include <crypto/ethash/include/ethash/keccak.hpp>
 #include "sync.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <list>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <system_error>
+#include <thread>
 
 #if !defined(__has_cpp_attribute)
 #define __has_cpp_attribute(x) 0
@@ -24,8 +35,239 @@ using namespace ethash;
 namespace
 {
 
-CCriticalSection shared_context_cs;
-std::shared_ptr<epoch_context> shared_context;
+/// The number of light epoch contexts kept alive: enough for the previous, the current and the next epoch, so
+/// validating headers from both sides of a boundary never rebuilds a context.
+constexpr size_t max_cached_contexts = 3;
+
+/// Light cache files start with this header, followed by the light cache items as they are in memory.
+struct light_cache_file_header
+{
+    uint32_t version;
+    int32_t epoch_number;
+    int32_t num_items;
+    hash256 seed;
+    hash256 checksum;  ///< keccak256 of the light cache items.
+};
+
+constexpr uint32_t light_cache_file_version = 1;
+
+std::mutex light_cache_dir_mutex;
+std::string light_cache_dir;  ///< Empty if light caches are not saved.
+
+std::string get_light_cache_dir()
+{
+    std::lock_guard<std::mutex> lock{light_cache_dir_mutex};
+    return light_cache_dir;
+}
+
+std::string get_light_cache_path(const std::string& dir, int epoch_number)
+{
+    return dir + "/light-cache-" + std::to_string(epoch_number) + ".dat";
+}
+
+hash256 get_light_cache_checksum(const hash512 cache[], int num_items)
+{
+    return keccak256(reinterpret_cast<const uint8_t*>(cache), get_light_cache_size(num_items));
+}
+}  // namespace
+
+namespace ethash
+{
+epoch_context_ptr load_light_cache(const std::string& dir, int epoch_number) noexcept
+{
+    FILE* file = std::fopen(get_light_cache_path(dir, epoch_number).c_str(), "rb");
+    if (!file)
+        return {nullptr, nullptr};
+
+    light_cache_file_header header;
+    epoch_context_ptr context{nullptr, nullptr};
+    if (std::fread(&header, sizeof(header), 1, file) == 1 && header.version == light_cache_file_version &&
+        header.epoch_number == epoch_number)
+    {
+        context = generic::create_epoch_context(epoch_number, [&](hash512 cache[], int num_items, const hash256& seed) {
+            return header.num_items == num_items && is_equal(header.seed, seed) &&
+                   std::fread(cache, sizeof(hash512), num_items, file) == static_cast<size_t>(num_items) &&
+                   is_equal(get_light_cache_checksum(cache, num_items), header.checksum);
+        });
+    }
+    std::fclose(file);
+    return context;
+}
+
+bool save_light_cache(const std::string& dir, const epoch_context& context) noexcept
+{
+    light_cache_file_header header;
+    header.version = light_cache_file_version;
+    header.epoch_number = context.epoch_number;
+    header.num_items = context.light_cache_num_items;
+    header.seed = calculate_epoch_seed(context.epoch_number);
+    header.checksum = get_light_cache_checksum(context.light_cache, context.light_cache_num_items);
+
+    // Write to a temporary file first so a crash never leaves a truncated cache behind.
+    const std::string path = get_light_cache_path(dir, context.epoch_number);
+    const std::string tmp_path = path + ".new";
+    FILE* file = std::fopen(tmp_path.c_str(), "wb");
+    if (!file)
+        return false;
+    bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   std::fwrite(context.light_cache, sizeof(hash512), header.num_items, file) ==
+                       static_cast<size_t>(header.num_items);
+    written = std::fclose(file) == 0 && written;
+
+    std::remove(path.c_str());
+    if (!written || std::rename(tmp_path.c_str(), path.c_str()) != 0)
+    {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+}  // namespace ethash
+
+namespace
+{
+
+/// Creates an epoch context, loading its light cache from the light cache directory if it was saved there before.
+std::shared_ptr<epoch_context> create_shared_epoch_context(int epoch_number)
+{
+    const std::string dir = get_light_cache_dir();
+    if (dir.empty())
+        return create_epoch_context(epoch_number);
+
+    epoch_context_ptr context = load_light_cache(dir, epoch_number);
+    if (!context)
+    {
+        context = create_epoch_context(epoch_number);
+        if (context && save_light_cache(dir, *context) && epoch_number >= static_cast<int>(max_cached_contexts))
+        {
+            // Remove the light cache of an epoch that has fallen out of use.
+            std::remove(get_light_cache_path(dir, epoch_number - static_cast<int>(max_cached_contexts)).c_str());
+        }
+    }
+    return std::move(context);
+}
+
+/// Light epoch contexts shared by all threads, with a background thread building the next epoch's context ahead of
+/// time.
+class context_cache
+{
+public:
+    ~context_cache()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            stopping = true;
+        }
+        cond.notify_all();
+        if (prebuild_thread.joinable())
+            prebuild_thread.join();
+    }
+
+    std::shared_ptr<epoch_context> get(int epoch_number)
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        while (true)
+        {
+            if (auto context = find(epoch_number, true))
+                return context;
+
+            // Wait for the thread that is building it instead of building it twice.
+            if (building.count(epoch_number) == 0)
+                return build(lock, epoch_number);
+            cond.wait(lock);
+        }
+    }
+
+    void prebuild(int epoch_number)
+    {
+        // Fast path: this epoch was requested already.
+        if (last_prebuild_request.exchange(epoch_number) == epoch_number)
+            return;
+
+        std::lock_guard<std::mutex> lock{mutex};
+        if (stopping || find(epoch_number, false) || building.count(epoch_number) != 0)
+            return;
+
+        prebuild_queue.push_back(epoch_number);
+        if (!prebuild_thread.joinable())
+        {
+            try
+            {
+                prebuild_thread = std::thread{&context_cache::prebuild_loop, this};
+            }
+            catch (const std::system_error&)
+            {
+                // Without the thread the context is built on first use, as before.
+                prebuild_queue.clear();
+                return;
+            }
+        }
+        cond.notify_all();
+    }
+
+private:
+    /// Requires mutex.
+    std::shared_ptr<epoch_context> find(int epoch_number, bool mark_used)
+    {
+        for (auto it = contexts.begin(); it != contexts.end(); ++it)
+        {
+            if ((*it)->epoch_number != epoch_number)
+                continue;
+            if (mark_used)
+                contexts.splice(contexts.begin(), contexts, it);
+            return *it;
+        }
+        return nullptr;
+    }
+
+    /// Requires mutex, which is released while the context is built.
+    std::shared_ptr<epoch_context> build(std::unique_lock<std::mutex>& lock, int epoch_number)
+    {
+        building.insert(epoch_number);
+        lock.unlock();
+
+        std::shared_ptr<epoch_context> context = create_shared_epoch_context(epoch_number);
+
+        lock.lock();
+        building.erase(epoch_number);
+        if (context)
+        {
+            // Drop the least recently used contexts. Threads still hashing with them keep their own references.
+            while (contexts.size() >= max_cached_contexts)
+                contexts.pop_back();
+            contexts.push_front(context);
+        }
+        cond.notify_all();
+        return context;
+    }
+
+    void prebuild_loop()
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        while (true)
+        {
+            cond.wait(lock, [this] { return stopping || !prebuild_queue.empty(); });
+            if (stopping)
+                return;
+
+            const int epoch_number = prebuild_queue.front();
+            prebuild_queue.pop_front();
+            if (!find(epoch_number, false) && building.count(epoch_number) == 0)
+                build(lock, epoch_number);
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::list<std::shared_ptr<epoch_context>> contexts;  ///< Most recently used first.
+    std::set<int> building;
+    std::deque<int> prebuild_queue;
+    std::thread prebuild_thread;
+    std::atomic<int> last_prebuild_request{-1};
+    bool stopping = false;
+};
+
+context_cache shared_contexts;
 thread_local std::shared_ptr<epoch_context> thread_local_context;
 
 CCriticalSection shared_context_full_cs;
@@ -36,27 +278,13 @@ thread_local std::shared_ptr<epoch_context_full> thread_local_context_full;
 ///
 /// This function is on the slow path. It's separated to allow inlining the fast
 /// path.
-///
-/// @todo: Redesign to guarantee deallocation before new allocation.
 ATTRIBUTE_NOINLINE
 void update_local_context(int epoch_number)
 {
     // Release the shared pointer of the obsoleted context.
     thread_local_context.reset();
 
-    // Local context invalid, check the shared context.
-    LOCK(shared_context_cs);
-
-    if (!shared_context || shared_context->epoch_number != epoch_number)
-    {
-        // Release the shared pointer of the obsoleted context.
-        shared_context.reset();
-
-        // Build new context.
-        shared_context = create_epoch_context(epoch_number);
-    }
-
-    thread_local_context = shared_context;
+    thread_local_context = shared_contexts.get(epoch_number);
 }
 
 ATTRIBUTE_NOINLINE
@@ -90,6 +318,17 @@ const ethash_epoch_context* ethash_get_global_epoch_context(int epoch_number) no
     return thread_local_context.get();
 }
 
+void ethash_prebuild_global_epoch_context(int epoch_number) noexcept
+{
+    shared_contexts.prebuild(epoch_number);
+}
+
+void ethash_set_global_light_cache_dir(const char* dir) noexcept
+{
+    std::lock_guard<std::mutex> lock{light_cache_dir_mutex};
+    light_cache_dir = dir ? dir : "";
+}
+
 const ethash_epoch_context_full* ethash_get_global_epoch_context_full(int epoch_number) noexcept
 {
     // Check if local context matches epoch number.
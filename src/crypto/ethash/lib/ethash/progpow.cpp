@@ -12,6 +12,10 @@
 
 #include <array>
 
+#if ETHASH_AVX2
+#include <immintrin.h>
+#endif
+
 namespace progpow
 {
 namespace
@@ -262,7 +266,7 @@ mix_array init_mix(uint32_t* hash_seed)
     return mix;
 }
 
-hash256 hash_mix(
+hash256 hash_mix_generic(
     const epoch_context& context, int block_number, uint32_t * seed, lookup_fn lookup) noexcept
 {
     auto mix = init_mix(seed);
@@ -293,6 +297,257 @@ hash256 hash_mix(
         mix_hash.word32s[l % num_words] = fnv1a(mix_hash.word32s[l % num_words], lane_hash[l]);
     return le::uint32s(mix_hash);
 }
+
+#if ETHASH_AVX2
+/// AVX2 version of the ProgPoW mix. The mix is kept transposed, as one pair of 8-lane vectors
+/// per register, so each mix step applies its (lane-independent) operation to all 16 lanes at
+/// once. It must stay bit-identical with hash_mix_generic().
+namespace avx2
+{
+using lanes = __m256i[2];
+using mix_array = lanes[num_regs];
+
+static_assert(num_lanes == 16, "the AVX2 mix assumes two 8-lane vectors");
+static_assert((l1_cache_num_items & (l1_cache_num_items - 1)) == 0, "l1 cache size must be a power of 2");
+
+#define PROGPOW_AVX2 __attribute__((target("avx2"), always_inline)) inline
+
+PROGPOW_AVX2 __m256i mul_hi32(__m256i a, __m256i b) noexcept
+{
+    const __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(a, b), 32);
+    const __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+    return _mm256_blend_epi32(even, odd, 0xaa);
+}
+
+PROGPOW_AVX2 __m256i rotl32(__m256i a, __m256i b) noexcept
+{
+    const __m256i c = _mm256_and_si256(b, _mm256_set1_epi32(31));
+    return _mm256_or_si256(
+        _mm256_sllv_epi32(a, c), _mm256_srlv_epi32(a, _mm256_sub_epi32(_mm256_set1_epi32(32), c)));
+}
+
+PROGPOW_AVX2 __m256i rotr32(__m256i a, __m256i b) noexcept
+{
+    const __m256i c = _mm256_and_si256(b, _mm256_set1_epi32(31));
+    return _mm256_or_si256(
+        _mm256_srlv_epi32(a, c), _mm256_sllv_epi32(a, _mm256_sub_epi32(_mm256_set1_epi32(32), c)));
+}
+
+PROGPOW_AVX2 __m256i popcount32(__m256i a) noexcept
+{
+    const __m256i nibble_counts =
+        _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    const __m256i byte_counts = _mm256_add_epi8(
+        _mm256_shuffle_epi8(nibble_counts, _mm256_and_si256(a, low_mask)),
+        _mm256_shuffle_epi8(nibble_counts, _mm256_and_si256(_mm256_srli_epi16(a, 4), low_mask)));
+    return _mm256_madd_epi16(
+        _mm256_maddubs_epi16(byte_counts, _mm256_set1_epi8(1)), _mm256_set1_epi16(1));
+}
+
+PROGPOW_AVX2 __m256i clz32(__m256i a) noexcept
+{
+    // Set all bits below the highest set one, then count the zeros left above it.
+    a = _mm256_or_si256(a, _mm256_srli_epi32(a, 1));
+    a = _mm256_or_si256(a, _mm256_srli_epi32(a, 2));
+    a = _mm256_or_si256(a, _mm256_srli_epi32(a, 4));
+    a = _mm256_or_si256(a, _mm256_srli_epi32(a, 8));
+    a = _mm256_or_si256(a, _mm256_srli_epi32(a, 16));
+    return _mm256_sub_epi32(_mm256_set1_epi32(32), popcount32(a));
+}
+
+PROGPOW_AVX2 __m256i random_math(__m256i a, __m256i b, uint32_t selector) noexcept
+{
+    switch (selector % 11)
+    {
+    default:
+    case 0:
+        return _mm256_add_epi32(a, b);
+    case 1:
+        return _mm256_mullo_epi32(a, b);
+    case 2:
+        return mul_hi32(a, b);
+    case 3:
+        return _mm256_min_epu32(a, b);
+    case 4:
+        return rotl32(a, b);
+    case 5:
+        return rotr32(a, b);
+    case 6:
+        return _mm256_and_si256(a, b);
+    case 7:
+        return _mm256_or_si256(a, b);
+    case 8:
+        return _mm256_xor_si256(a, b);
+    case 9:
+        return _mm256_add_epi32(clz32(a), clz32(b));
+    case 10:
+        return _mm256_add_epi32(popcount32(a), popcount32(b));
+    }
+}
+
+PROGPOW_AVX2 void random_merge(__m256i& a, __m256i b, uint32_t selector) noexcept
+{
+    const auto x = (selector >> 16) % 31 + 1;  // Additional non-zero selector from higher bits.
+    const __m128i left = _mm_cvtsi32_si128(static_cast<int>(x));
+    const __m128i right = _mm_cvtsi32_si128(static_cast<int>(32 - x));
+    switch (selector % 4)
+    {
+    case 0:
+        a = _mm256_add_epi32(_mm256_mullo_epi32(a, _mm256_set1_epi32(33)), b);
+        break;
+    case 1:
+        a = _mm256_mullo_epi32(_mm256_xor_si256(a, b), _mm256_set1_epi32(33));
+        break;
+    case 2:
+        a = _mm256_xor_si256(_mm256_or_si256(_mm256_sll_epi32(a, left), _mm256_srl_epi32(a, right)), b);
+        break;
+    case 3:
+        a = _mm256_xor_si256(_mm256_or_si256(_mm256_srl_epi32(a, left), _mm256_sll_epi32(a, right)), b);
+        break;
+    }
+}
+
+#undef PROGPOW_AVX2
+
+__attribute__((target("avx2")))
+void round(
+    const epoch_context& context, uint32_t r, mix_array& mix, mix_rng_state state, lookup_fn lookup)
+{
+    const uint32_t num_items = static_cast<uint32_t>(context.full_dataset_num_items / 2);
+    const uint32_t lane = r % num_lanes;
+    const uint32_t item_index =
+        static_cast<uint32_t>(_mm256_cvtsi256_si32(_mm256_permutevar8x32_epi32(
+            mix[0][lane / 8], _mm256_set1_epi32(static_cast<int>(lane % 8))))) % num_items;
+    const hash2048 item = lookup(context, item_index);
+
+    constexpr size_t num_words_per_lane = sizeof(item) / (sizeof(uint32_t) * num_lanes);
+    constexpr int max_operations =
+        num_cache_accesses > num_math_operations ? num_cache_accesses : num_math_operations;
+
+    const int* const l1_cache = reinterpret_cast<const int*>(context.l1_cache);
+    const __m256i l1_mask = _mm256_set1_epi32(l1_cache_num_items - 1);
+
+    // Process lanes.
+    for (int i = 0; i < max_operations; ++i)
+    {
+        if (i < num_cache_accesses)  // Random access to cached memory.
+        {
+            const auto src = state.next_src();
+            const auto dst = state.next_dst();
+            const auto sel = state.rng();
+
+            for (size_t h = 0; h < 2; ++h)
+            {
+                const __m256i offset = _mm256_and_si256(mix[src][h], l1_mask);
+                random_merge(mix[dst][h], _mm256_i32gather_epi32(l1_cache, offset, 4), sel);
+            }
+        }
+        if (i < num_math_operations)  // Random math.
+        {
+            // Generate 2 unique source indexes.
+            const auto src_rnd = state.rng() % (num_regs * (num_regs - 1));
+            const auto src1 = src_rnd % num_regs;  // O <= src1 < num_regs
+            auto src2 = src_rnd / num_regs;        // 0 <= src2 < num_regs - 1
+            if (src2 >= src1)
+                ++src2;
+
+            const auto sel1 = state.rng();
+            const auto dst = state.next_dst();
+            const auto sel2 = state.rng();
+
+            for (size_t h = 0; h < 2; ++h)
+                random_merge(mix[dst][h], random_math(mix[src1][h], mix[src2][h], sel1), sel2);
+        }
+    }
+
+    // DAG access pattern.
+    uint32_t dsts[num_words_per_lane];
+    uint32_t sels[num_words_per_lane];
+    for (size_t i = 0; i < num_words_per_lane; ++i)
+    {
+        dsts[i] = i == 0 ? 0 : state.next_dst();
+        sels[i] = state.rng();
+    }
+
+    // DAG access, lane l reads the words of item at ((l ^ r) % num_lanes) * num_words_per_lane.
+    const int* const item_words = reinterpret_cast<const int*>(item.word32s);
+    const __m256i lane_ids[2] = {_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+        _mm256_setr_epi32(8, 9, 10, 11, 12, 13, 14, 15)};
+    for (size_t h = 0; h < 2; ++h)
+    {
+        const __m256i offset = _mm256_slli_epi32(
+            _mm256_and_si256(_mm256_xor_si256(lane_ids[h], _mm256_set1_epi32(static_cast<int>(r))),
+                _mm256_set1_epi32(num_lanes - 1)),
+            2);
+        for (size_t i = 0; i < num_words_per_lane; ++i)
+        {
+            const __m256i words = _mm256_i32gather_epi32(
+                item_words, _mm256_add_epi32(offset, _mm256_set1_epi32(static_cast<int>(i))), 4);
+            random_merge(mix[dsts[i]][h], words, sels[i]);
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+hash256 hash_mix(
+    const epoch_context& context, int block_number, uint32_t * seed, lookup_fn lookup) noexcept
+{
+    const ::progpow::mix_array init = init_mix(seed);
+    mix_array mix;
+    for (uint32_t i = 0; i < num_regs; ++i)
+    {
+        alignas(32) uint32_t column[num_lanes];
+        for (size_t l = 0; l < num_lanes; ++l)
+            column[l] = init[l][i];
+        mix[i][0] = _mm256_load_si256(reinterpret_cast<const __m256i*>(&column[0]));
+        mix[i][1] = _mm256_load_si256(reinterpret_cast<const __m256i*>(&column[8]));
+    }
+
+    auto number = uint64_t(block_number / period_length);
+    uint32_t new_state[2];
+    new_state[0] = number;
+    new_state[1] = number >> 32;
+    mix_rng_state state{new_state};
+
+    for (uint32_t i = 0; i < 64; ++i)
+        round(context, i, mix, state, lookup);
+
+    // Reduce mix data to a single per-lane result.
+    const __m256i prime = _mm256_set1_epi32(static_cast<int>(fnv_prime));
+    __m256i lane_hash_vec[2] = {_mm256_set1_epi32(static_cast<int>(fnv_offset_basis)),
+        _mm256_set1_epi32(static_cast<int>(fnv_offset_basis))};
+    for (uint32_t i = 0; i < num_regs; ++i)
+    {
+        for (size_t h = 0; h < 2; ++h)
+            lane_hash_vec[h] = _mm256_mullo_epi32(_mm256_xor_si256(lane_hash_vec[h], mix[i][h]), prime);
+    }
+    alignas(32) uint32_t lane_hash[num_lanes];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(&lane_hash[0]), lane_hash_vec[0]);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(&lane_hash[8]), lane_hash_vec[1]);
+
+    // Reduce all lanes to a single 256-bit result.
+    static constexpr size_t num_words = sizeof(hash256) / sizeof(uint32_t);
+    hash256 mix_hash;
+    for (uint32_t& w : mix_hash.word32s)
+        w = fnv_offset_basis;
+    for (size_t l = 0; l < num_lanes; ++l)
+        mix_hash.word32s[l % num_words] = fnv1a(mix_hash.word32s[l % num_words], lane_hash[l]);
+    return le::uint32s(mix_hash);
+}
+}  // namespace avx2
+#endif
+
+hash256 hash_mix(
+    const epoch_context& context, int block_number, uint32_t * seed, lookup_fn lookup) noexcept
+{
+#if ETHASH_AVX2
+    if (ethash::avx2::is_enabled())
+        return avx2::hash_mix(context, block_number, seed, lookup);
+#endif
+    return hash_mix_generic(context, block_number, seed, lookup);
+}
 }  // namespace
 
 result hash(const epoch_context& context, int block_number, const hash256& header_hash,
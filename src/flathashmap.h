@@ -0,0 +1,337 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef YOTTAFLUX_FLATHASHMAP_H
+#define YOTTAFLUX_FLATHASHMAP_H
+
+#include "crypto/common.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * A hash map with open addressing, holding its entries in an arena.
+ *
+ * The table is a flat array of 8-byte slots, each holding 32 bits of the key's hash and the index of the entry, probed
+ * linearly, so a lookup touches one cache line of slots and only follows the entries whose hash matches. Entries are
+ * constructed in place in chunks that are never moved or freed until the map is cleared, and erased entries are
+ * recycled, so inserting and erasing do not allocate per entry and, as with std::unordered_map, references to entries
+ * stay valid until they are erased.
+ *
+ * Implements the part of the std::unordered_map interface the coins cache needs. Iterators are invalidated by
+ * inserting (the table may grow), but not by erasing other entries, so erasing while iterating with erase(it++) works.
+ */
+template <typename K, typename T, typename Hash>
+class flathashmap
+{
+public:
+    typedef K key_type;
+    typedef T mapped_type;
+    typedef std::pair<const K, T> value_type;
+    typedef size_t size_type;
+
+    struct slot_type {
+        uint32_t tag;   //!< SLOT_EMPTY, SLOT_ERASED, or the low bits of the key's hash, which also give its position
+        uint32_t node;
+    };
+
+    typedef typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type node_type;
+
+    /** Entries in the first chunk. Chunks double in size from there up to MAX_CHUNK_NODES */
+    static const uint32_t MIN_CHUNK_NODES = 16;
+    static const uint32_t MAX_CHUNK_NODES = MIN_CHUNK_NODES << 8;
+
+private:
+    static const uint32_t SLOT_EMPTY = 0;
+    static const uint32_t SLOT_ERASED = 1;
+    static const uint32_t MIN_SLOTS = 16;
+
+    Hash hasher;
+    std::vector<slot_type> slots;
+    size_t nSize;
+    size_t nErased;
+
+    std::vector<std::unique_ptr<node_type[]> > chunks;
+    uint32_t nNodes;
+    std::vector<uint32_t> vFreeNodes;
+
+    static uint32_t GetTag(size_t hash)
+    {
+        uint32_t tag = (uint32_t)hash;
+        return tag < 2 ? tag + 2 : tag;
+    }
+
+    /** Chunk c holds 16 nodes for c = 0 and 2^(c+3) after that, up to MAX_CHUNK_NODES */
+    static uint32_t ChunkNodes(size_t c)
+    {
+        return c == 0 ? MIN_CHUNK_NODES : MIN_CHUNK_NODES << std::min<size_t>(c - 1, 8);
+    }
+
+    value_type* Node(uint32_t i) const
+    {
+        size_t c, offset;
+        if (i < MIN_CHUNK_NODES) {
+            c = 0;
+            offset = i;
+        } else if (i < MAX_CHUNK_NODES) {
+            int nBits = CountBits(i) - 1;
+            c = nBits - 3;
+            offset = i - (1U << nBits);
+        } else {
+            c = i / MAX_CHUNK_NODES + 8;
+            offset = i % MAX_CHUNK_NODES;
+        }
+        return reinterpret_cast<value_type*>(&chunks[c][offset]);
+    }
+
+    uint32_t AllocNode()
+    {
+        if (!vFreeNodes.empty()) {
+            uint32_t i = vFreeNodes.back();
+            vFreeNodes.pop_back();
+            return i;
+        }
+        if (nNodes == node_capacity())
+            chunks.emplace_back(new node_type[ChunkNodes(chunks.size())]);
+        return nNodes++;
+    }
+
+    /** Find the slot of a key, or the slot it would be inserted in (the first erased slot on its way, if any) */
+    size_t FindSlot(const K& key, uint32_t tag, bool& fFound) const
+    {
+        const size_t mask = slots.size() - 1;
+        size_t nInsert = slots.size();
+        for (size_t i = tag & mask; ; i = (i + 1) & mask) {
+            const slot_type& slot = slots[i];
+            if (slot.tag == SLOT_EMPTY) {
+                fFound = false;
+                return nInsert < slots.size() ? nInsert : i;
+            }
+            if (slot.tag == SLOT_ERASED) {
+                if (nInsert == slots.size())
+                    nInsert = i;
+            } else if (slot.tag == tag && Node(slot.node)->first == key) {
+                fFound = true;
+                return i;
+            }
+        }
+    }
+
+    /** Resize the table to nSlots (a power of two), which also drops erased slots */
+    void Rehash(size_t nSlots)
+    {
+        std::vector<slot_type> slotsOld(std::move(slots));
+        slots.assign(nSlots, slot_type{SLOT_EMPTY, 0});
+        const size_t mask = nSlots - 1;
+        for (const slot_type& slot : slotsOld) {
+            if (slot.tag < 2)
+                continue;
+            size_t i = slot.tag & mask;
+            while (slots[i].tag != SLOT_EMPTY)
+                i = (i + 1) & mask;
+            slots[i] = slot;
+        }
+        nErased = 0;
+    }
+
+    /** Make room for one more entry, keeping the table at most 3/4 full counting erased slots */
+    void Reserve()
+    {
+        if ((nSize + nErased + 1) * 4 <= slots.size() * 3)
+            return;
+        // At most half full afterwards, so the table doubles when growing, and stays the same size when it only
+        // fills up with erased slots
+        size_t nSlots = MIN_SLOTS;
+        while (nSlots < (nSize + 1) * 2)
+            nSlots *= 2;
+        Rehash(nSlots);
+    }
+
+    /** Insert the entry in node i unless its key is already there, in which case node i is released */
+    std::pair<size_t, bool> InsertNode(uint32_t i)
+    {
+        Reserve();
+        const uint32_t tag = GetTag(hasher(Node(i)->first));
+        bool fFound;
+        size_t nSlot = FindSlot(Node(i)->first, tag, fFound);
+        if (fFound) {
+            Node(i)->~value_type();
+            vFreeNodes.push_back(i);
+            return std::make_pair(nSlot, false);
+        }
+        if (slots[nSlot].tag == SLOT_ERASED)
+            nErased--;
+        slots[nSlot] = slot_type{tag, i};
+        nSize++;
+        return std::make_pair(nSlot, true);
+    }
+
+    template <bool fConst>
+    class iterator_base
+    {
+        friend class flathashmap;
+        template <bool> friend class iterator_base;
+
+        typedef typename std::conditional<fConst, const flathashmap*, flathashmap*>::type map_pointer;
+        map_pointer map;
+        size_t nSlot;
+
+        iterator_base(map_pointer mapIn, size_t nSlotIn) : map(mapIn), nSlot(nSlotIn) { SkipEmpty(); }
+
+        void SkipEmpty()
+        {
+            while (nSlot < map->slots.size() && map->slots[nSlot].tag < 2)
+                nSlot++;
+        }
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef typename flathashmap::value_type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef typename std::conditional<fConst, const value_type*, value_type*>::type pointer;
+        typedef typename std::conditional<fConst, const value_type&, value_type&>::type reference;
+
+        iterator_base() : map(nullptr), nSlot(0) {}
+        // Allow iterator -> const_iterator
+        iterator_base(const iterator_base<false>& other) : map(other.map), nSlot(other.nSlot) {}
+
+        reference operator*() const { return *map->Node(map->slots[nSlot].node); }
+        pointer operator->() const { return map->Node(map->slots[nSlot].node); }
+
+        iterator_base& operator++() { nSlot++; SkipEmpty(); return *this; }
+        iterator_base operator++(int) { iterator_base copy(*this); ++(*this); return copy; }
+
+        bool operator==(const iterator_base& other) const { return nSlot == other.nSlot; }
+        bool operator!=(const iterator_base& other) const { return nSlot != other.nSlot; }
+    };
+
+public:
+    typedef iterator_base<false> iterator;
+    typedef iterator_base<true> const_iterator;
+
+    flathashmap() : nSize(0), nErased(0), nNodes(0) {}
+    ~flathashmap() { clear(); }
+
+    flathashmap(const flathashmap&) = delete;
+    flathashmap& operator=(const flathashmap&) = delete;
+
+    size_t size() const { return nSize; }
+    bool empty() const { return nSize == 0; }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, slots.size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, slots.size()); }
+
+    iterator find(const K& key)
+    {
+        if (nSize == 0)
+            return end();
+        bool fFound;
+        size_t nSlot = FindSlot(key, GetTag(hasher(key)), fFound);
+        return fFound ? iterator(this, nSlot) : end();
+    }
+
+    const_iterator find(const K& key) const
+    {
+        return const_cast<flathashmap*>(this)->find(key);
+    }
+
+    size_t count(const K& key) const { return find(key) != end(); }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args)
+    {
+        uint32_t i = AllocNode();
+        new (Node(i)) value_type(std::forward<Args>(args)...);
+        std::pair<size_t, bool> ret = InsertNode(i);
+        return std::make_pair(iterator(this, ret.first), ret.second);
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value) { return emplace(value); }
+    std::pair<iterator, bool> insert(value_type&& value) { return emplace(std::move(value)); }
+
+    T& operator[](const K& key)
+    {
+        iterator it = find(key);
+        if (it == end())
+            it = emplace(std::piecewise_construct, std::forward_as_tuple(key), std::tuple<>()).first;
+        return it->second;
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        assert(pos.map == this && pos.nSlot < slots.size());
+        slot_type& slot = slots[pos.nSlot];
+        Node(slot.node)->~value_type();
+        vFreeNodes.push_back(slot.node);
+        slot.tag = SLOT_ERASED;
+        nSize--;
+        nErased++;
+        return iterator(this, pos.nSlot + 1);
+    }
+
+    size_t erase(const K& key)
+    {
+        iterator it = find(key);
+        if (it == end())
+            return 0;
+        erase(it);
+        return 1;
+    }
+
+    /** Erase all entries and release all memory */
+    void clear()
+    {
+        for (const slot_type& slot : slots) {
+            if (slot.tag >= 2)
+                Node(slot.node)->~value_type();
+        }
+        std::vector<slot_type>().swap(slots);
+        std::vector<std::unique_ptr<node_type[]> >().swap(chunks);
+        std::vector<uint32_t>().swap(vFreeNodes);
+        nSize = 0;
+        nErased = 0;
+        nNodes = 0;
+    }
+
+    void swap(flathashmap& other)
+    {
+        std::swap(hasher, other.hasher);
+        slots.swap(other.slots);
+        std::swap(nSize, other.nSize);
+        std::swap(nErased, other.nErased);
+        chunks.swap(other.chunks);
+        std::swap(nNodes, other.nNodes);
+        vFreeNodes.swap(other.vFreeNodes);
+    }
+
+    /** Number of slots in the table */
+    size_t bucket_count() const { return slots.size(); }
+    /** Number of chunks in the arena, and the number of entries each one holds */
+    size_t chunk_count() const { return chunks.size(); }
+    static size_t chunk_nodes(size_t c) { return ChunkNodes(c); }
+    /** Number of entries the arena has room for */
+    uint32_t node_capacity() const
+    {
+        uint32_t n = 0;
+        for (size_t c = 0; c < chunks.size() && c <= 9; c++)
+            n += ChunkNodes(c);
+        if (chunks.size() > 10)
+            n += (chunks.size() - 10) * MAX_CHUNK_NODES;
+        return n;
+    }
+    size_t free_list_capacity() const { return vFreeNodes.capacity(); }
+};
+
+#endif // YOTTAFLUX_FLATHASHMAP_H
@@ -12,6 +12,9 @@
 
 #include <crypto/ethash/include/ethash/progpow.hpp>
 
+/** How many blocks before an epoch boundary the next epoch's context starts building in the background */
+static const int KAWPOW_EPOCH_PREBUILD_BLOCKS = 500;
+
 //TODO remove these
 double algoHashTotal[16];
 int algoHashHits[16];
@@ -257,36 +260,34 @@ uint64_t SipHashUint256Extra(uint64_t k0, uint64_t k1, const uint256& val, uint3
 
 uint256 KAWPOWHash(const CBlockHeader& blockHeader, uint256& mix_hash)
 {
-    static ethash::epoch_context_ptr context{nullptr, nullptr};
-
     // Get the context from the block height
     const auto epoch_number = ethash::get_epoch_number(blockHeader.nHeight);
+    const auto& context = ethash::get_global_epoch_context(epoch_number);
 
-    if (!context || context->epoch_number != epoch_number)
-        context = ethash::create_epoch_context(epoch_number);
+    // Build the next epoch's context in the background before the boundary, so no validation thread waits for it
+    if (blockHeader.nHeight % ethash::epoch_length >= ethash::epoch_length - KAWPOW_EPOCH_PREBUILD_BLOCKS)
+        ethash::prebuild_global_epoch_context(epoch_number + 1);
 
     // Build the header_hash
-    uint256 nHeaderHash = blockHeader.GetKAWPOWHeaderHash();
-    const auto header_hash = to_hash256(nHeaderHash.GetHex());
+    const auto header_hash = to_hash256(blockHeader.GetKAWPOWHeaderHash());
 
     // ProgPow hash
-    const auto result = progpow::hash(*context, blockHeader.nHeight, header_hash, blockHeader.nNonce64);
+    const auto result = progpow::hash(context, blockHeader.nHeight, header_hash, blockHeader.nNonce64);
 
-    mix_hash = uint256S(to_hex(result.mix_hash));
-    return uint256S(to_hex(result.final_hash));
+    mix_hash = to_uint256(result.mix_hash);
+    return to_uint256(result.final_hash);
 }
 
 
 uint256 KAWPOWHash_OnlyMix(const CBlockHeader& blockHeader)
 {
     // Build the header_hash
-    uint256 nHeaderHash = blockHeader.GetKAWPOWHeaderHash();
-    const auto header_hash = to_hash256(nHeaderHash.GetHex());
+    const auto header_hash = to_hash256(blockHeader.GetKAWPOWHeaderHash());
 
     // ProgPow hash
-    const auto result = progpow::hash_no_verify(blockHeader.nHeight, header_hash, to_hash256(blockHeader.mix_hash.GetHex()), blockHeader.nNonce64);
+    const auto result = progpow::hash_no_verify(blockHeader.nHeight, header_hash, to_hash256(blockHeader.mix_hash), blockHeader.nNonce64);
 
-    return uint256S(to_hex(result));
+    return to_uint256(result);
 }
 
 
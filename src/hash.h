@@ -8,6 +8,8 @@
 #define YOTTAFLUX_HASH_H
 #include <iostream>
 #include <chrono>
+#include <algorithm>
+#include <iterator>
 #include "crypto/ripemd160.h"
 #include "crypto/sha256.h"
 #include "prevector.h"
@@ -605,6 +607,22 @@ inline uint256 HashX16RV2(const T1 pbegin, const T1 pend, const uint256 PrevBloc
     return hash[15].trim256();
 }
 
+/** uint256 keeps its bytes in reverse order to ethash::hash256 (which is what GetHex/uint256S account for), so the
+ * conversions between them just reverse the bytes */
+inline ethash::hash256 to_hash256(const uint256& n)
+{
+    ethash::hash256 hash;
+    std::reverse_copy(n.begin(), n.end(), hash.bytes);
+    return hash;
+}
+
+inline uint256 to_uint256(const ethash::hash256& hash)
+{
+    uint256 n;
+    std::reverse_copy(std::begin(hash.bytes), std::end(hash.bytes), n.begin());
+    return n;
+}
+
 uint256 KAWPOWHash(const CBlockHeader& blockHeader, uint256& mix_hash);
 uint256 KAWPOWHash_OnlyMix(const CBlockHeader& blockHeader);
 
@@ -0,0 +1,251 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "index/base.h"
+
+#include "chainparams.h"
+#include "init.h"
+#include "tinyformat.h"
+#include "txdb.h"
+#include "ui_interface.h"
+#include "undo.h"
+#include "util.h"
+#include "utiltime.h"
+#include "validation.h"
+#include "warnings.h"
+
+#include <chrono>
+#include <functional>
+
+/** How often the sync thread logs its progress while catching up */
+static const int64_t INDEX_SYNC_LOG_INTERVAL = 30;
+
+BaseIndex::BaseIndex() : m_best_block_index(nullptr), m_interrupt(false), m_failed(false), m_notified(false)
+{
+}
+
+BaseIndex::~BaseIndex()
+{
+    Stop();
+}
+
+bool BaseIndex::Init()
+{
+    LOCK(cs_main);
+
+    uint256 hashBest;
+    if (pblocktree->ReadIndexBestBlock(GetName(), hashBest)) {
+        BlockMap::const_iterator it = mapBlockIndex.find(hashBest);
+        if (it == mapBlockIndex.end())
+            return error("%s: best block %s of the %s is not in the block index", __func__, hashBest.ToString(), GetName());
+        m_best_block_index = it->second;
+        return true;
+    }
+
+    // Older versions wrote this index from inside ConnectBlock and only kept a flag saying it was enabled, so an
+    // index with the flag set is as far along as the chain state. Give it a best block of its own and drop the flag
+    bool fLegacyIndex = false;
+    if (pblocktree->ReadFlag(GetName(), fLegacyIndex) && fLegacyIndex && chainActive.Tip()) {
+        if (!WriteBestBlock(chainActive.Tip()) || !pblocktree->WriteFlag(GetName(), false))
+            return error("%s: failed to write the best block of the %s", __func__, GetName());
+        m_best_block_index = chainActive.Tip();
+        LogPrintf("%s: %s upgraded at height %d\n", __func__, GetName(), chainActive.Height());
+    }
+
+    return true;
+}
+
+void BaseIndex::Start()
+{
+    RegisterValidationInterface(this);
+    m_thread_sync = std::thread(&TraceThread<std::function<void()> >, GetName(), std::function<void()>(std::bind(&BaseIndex::ThreadSync, this)));
+}
+
+void BaseIndex::Stop()
+{
+    if (!m_thread_sync.joinable())
+        return;
+
+    UnregisterValidationInterface(this);
+
+    m_interrupt = true;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cond.notify_all();
+    }
+
+    m_thread_sync.join();
+}
+
+bool BaseIndex::WriteBestBlock(const CBlockIndex* pindex)
+{
+    return pblocktree->WriteIndexBestBlock(GetName(), pindex->GetBlockHash());
+}
+
+void BaseIndex::BlockConnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex, const std::vector<CTransactionRef>& txnConflicted)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_pending_blocks.emplace(pindex->GetBlockHash(), block).second) {
+        m_pending_order.push_back(pindex->GetBlockHash());
+        if (m_pending_order.size() > MAX_INDEX_PENDING_BLOCKS) {
+            m_pending_blocks.erase(m_pending_order.front());
+            m_pending_order.pop_front();
+        }
+    }
+    m_notified = true;
+    m_cond.notify_all();
+}
+
+void BaseIndex::BlockDisconnected(const std::shared_ptr<const CBlock>& block)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_notified = true;
+    m_cond.notify_all();
+}
+
+const CBlockIndex* BaseIndex::NextSyncBlock(bool& fRewind, CDiskBlockPos& undoPos, std::shared_ptr<const CBlock>& pblock)
+{
+    LOCK(cs_main);
+
+    // Nothing to do until the chain has a tip, e.g. while -reindex has not connected the genesis block yet
+    const CBlockIndex* pindexTip = chainActive.Tip();
+    if (!pindexTip)
+        return nullptr;
+
+    const CBlockIndex* pindexBest = m_best_block_index.load();
+    const CBlockIndex* pindex;
+    if (pindexBest && !chainActive.Contains(pindexBest)) {
+        // The index is ahead of the chain state on the same branch, as happens while -reindex-chainstate reconnects
+        // blocks. The chain will catch up with it unless the blocks have since been marked invalid
+        if (pindexBest->GetAncestor(pindexTip->nHeight) == pindexTip && !(pindexBest->nStatus & BLOCK_FAILED_MASK))
+            return nullptr;
+
+        fRewind = true;
+        pindex = pindexBest;
+    } else {
+        fRewind = false;
+        pindex = pindexBest ? chainActive.Next(pindexBest) : chainActive.Genesis();
+        if (!pindex)
+            return nullptr;
+    }
+
+    undoPos = pindex->GetUndoPos();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_pending_blocks.find(pindex->GetBlockHash());
+    if (it != m_pending_blocks.end())
+        pblock = it->second;
+
+    return pindex;
+}
+
+void BaseIndex::SetBestBlockIndex(const CBlockIndex* pindex)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_best_block_index = pindex;
+    m_cond.notify_all();
+}
+
+void BaseIndex::ThreadSync()
+{
+    int64_t nLastLogTime = GetTime();
+
+    while (!m_interrupt) {
+        bool fRewind = false;
+        CDiskBlockPos undoPos;
+        std::shared_ptr<const CBlock> pblock;
+        const CBlockIndex* pindex = NextSyncBlock(fRewind, undoPos, pblock);
+
+        if (!pindex) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait_for(lock, std::chrono::seconds(1), [this] { return m_notified || m_interrupt; });
+            m_notified = false;
+            continue;
+        }
+
+        // The genesis block's outputs are not part of the chain state, so it has no entries
+        if (!pindex->pprev) {
+            if (!WriteBestBlock(pindex)) {
+                FatalError(strprintf("%s: Failed to write the best block of the %s", __func__, GetName()));
+                return;
+            }
+            SetBestBlockIndex(pindex);
+            continue;
+        }
+
+        if (!pblock) {
+            std::shared_ptr<CBlock> pblockRead = std::make_shared<CBlock>();
+            if (!ReadBlockFromDisk(*pblockRead, pindex, GetParams().GetConsensus())) {
+                FatalError(strprintf("%s: Failed to read block %s from disk", __func__, pindex->GetBlockHash().ToString()));
+                return;
+            }
+            pblock = pblockRead;
+        }
+
+        CBlockUndo blockundo;
+        if (!UndoReadFromDisk(blockundo, undoPos, pindex->pprev->GetBlockHash())) {
+            FatalError(strprintf("%s: Failed to read undo data of block %s from disk", __func__, pindex->GetBlockHash().ToString()));
+            return;
+        }
+
+        if (fRewind) {
+            if (!RewindBlock(*pblock, blockundo, pindex)) {
+                FatalError(strprintf("%s: Failed to rewind the %s past block %s", __func__, GetName(), pindex->GetBlockHash().ToString()));
+                return;
+            }
+            SetBestBlockIndex(pindex->pprev);
+        } else {
+            if (!WriteBlock(*pblock, blockundo, pindex)) {
+                FatalError(strprintf("%s: Failed to write block %s to the %s", __func__, pindex->GetBlockHash().ToString(), GetName()));
+                return;
+            }
+            SetBestBlockIndex(pindex);
+        }
+
+        int64_t nNow = GetTime();
+        if (nNow - nLastLogTime >= INDEX_SYNC_LOG_INTERVAL) {
+            LogPrintf("Syncing %s with block chain from height %d\n", GetName(), pindex->nHeight);
+            nLastLogTime = nNow;
+        }
+    }
+}
+
+bool BaseIndex::BlockUntilSyncedToCurrentChain()
+{
+    while (!m_interrupt && !m_failed) {
+        const CBlockIndex* pindexTip;
+        {
+            LOCK(cs_main);
+            pindexTip = chainActive.Tip();
+        }
+        if (!pindexTip)
+            return true;
+
+        // Re-read the tip every so often in case a reorg has taken the one we are waiting for out of the chain
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto synced = [this, pindexTip] {
+            const CBlockIndex* pindexBest = m_best_block_index.load();
+            return pindexBest && pindexBest->GetAncestor(pindexTip->nHeight) == pindexTip && !(pindexBest->nStatus & BLOCK_FAILED_MASK);
+        };
+        if (m_cond.wait_for(lock, std::chrono::seconds(1), [this, &synced] { return synced() || m_interrupt || m_failed; }))
+            return synced();
+    }
+
+    return false;
+}
+
+bool BaseIndex::FatalError(const std::string& strMessage)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_failed = true;
+        m_cond.notify_all();
+    }
+
+    SetMiscWarning(strMessage);
+    LogPrintf("*** %s\n", strMessage);
+    uiInterface.ThreadSafeMessageBox(_("Error: A fatal internal error occurred, see debug.log for details"), "", CClientUIInterface::MSG_ERROR);
+    StartShutdown();
+    return false;
+}
@@ -0,0 +1,100 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef YOTTAFLUX_INDEX_BASE_H
+#define YOTTAFLUX_INDEX_BASE_H
+
+#include "chain.h"
+#include "primitives/block.h"
+#include "uint256.h"
+#include "validationinterface.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class CBlockUndo;
+
+/** Maximum number of connected blocks kept in memory for an index that has not caught up with them yet */
+static const unsigned int MAX_INDEX_PENDING_BLOCKS = 16;
+
+/**
+ * Base class for the optional block indexes that are built off the active chain rather than from inside
+ * ConnectBlock. Each index runs its own thread that walks from its own best block (stored under its name in the
+ * block tree database) towards the tip, writing one block at a time, and rewinds blocks the active chain has
+ * disconnected. Block validation never waits on it: BlockConnected only hands over the block and wakes the thread.
+ */
+class BaseIndex : public CValidationInterface
+{
+private:
+    /** The last block whose entries have been written. nullptr if nothing has been indexed yet */
+    std::atomic<const CBlockIndex*> m_best_block_index;
+
+    std::atomic<bool> m_interrupt;
+    std::atomic<bool> m_failed;
+    std::thread m_thread_sync;
+
+    /** Guards the pending blocks and wakes the sync thread and anyone waiting for it */
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_notified;
+
+    /** Recently connected blocks, so the sync thread does not have to read them back from disk */
+    std::map<uint256, std::shared_ptr<const CBlock>> m_pending_blocks;
+    std::deque<uint256> m_pending_order;
+
+    /** Walk the index to the active chain tip and keep it there until interrupted */
+    void ThreadSync();
+
+    /** Pick the block the index should write or rewind next. Returns nullptr if there is nothing to do */
+    const CBlockIndex* NextSyncBlock(bool& fRewind, CDiskBlockPos& undoPos, std::shared_ptr<const CBlock>& pblock);
+
+    void SetBestBlockIndex(const CBlockIndex* pindex);
+    bool FatalError(const std::string& strMessage);
+
+protected:
+    void BlockConnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex, const std::vector<CTransactionRef>& txnConflicted) override;
+    void BlockDisconnected(const std::shared_ptr<const CBlock>& block) override;
+
+    /** Write the entries of a block connected on top of the index's best block, along with the new best block */
+    virtual bool WriteBlock(const CBlock& block, const CBlockUndo& blockundo, const CBlockIndex* pindex) = 0;
+
+    /** Remove the entries of the index's best block, moving its best block back to pindex->pprev */
+    virtual bool RewindBlock(const CBlock& block, const CBlockUndo& blockundo, const CBlockIndex* pindex) = 0;
+
+    /** Move the best block without writing any entries, as is done for the genesis block */
+    virtual bool WriteBestBlock(const CBlockIndex* pindex);
+
+    /** Name of the index, used for its flag and best block in the block tree database and in log messages */
+    virtual const char* GetName() const = 0;
+
+public:
+    BaseIndex();
+    virtual ~BaseIndex();
+
+    /** Load the index's best block. Must be called after the block index has been loaded */
+    bool Init();
+
+    /** Start the sync thread and subscribe to validation notifications */
+    void Start();
+
+    /** Stop the sync thread and unsubscribe. Must not be called with cs_main held */
+    void Stop();
+
+    /**
+     * Wait until the index has caught up with the active chain tip as of the call, so that reads from it are as
+     * current as the chain. Returns false if the index has failed or is shutting down. Must not be called with
+     * cs_main held.
+     */
+    bool BlockUntilSyncedToCurrentChain();
+
+    const CBlockIndex* GetBestBlockIndex() const { return m_best_block_index.load(); }
+};
+
+#endif // YOTTAFLUX_INDEX_BASE_H
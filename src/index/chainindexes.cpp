@@ -0,0 +1,226 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "index/chainindexes.h"
+
+#include "addressindex.h"
+#include "assets/assets.h"
+#include "hash.h"
+#include "spentindex.h"
+#include "timestampindex.h"
+#include "txdb.h"
+#include "undo.h"
+#include "util.h"
+#include "validation.h"
+
+std::unique_ptr<AddressIndex> g_address_index;
+std::unique_ptr<SpentIndex> g_spent_index;
+std::unique_ptr<TimestampIndex> g_timestamp_index;
+
+/**
+ * Find the address an output pays to as the indexes key it: its type (1 for a public key hash, 2 for a script hash)
+ * and hash, and the asset and amount it carries, which are YAI and the output's value for plain payments. Returns
+ * false for outputs that do not pay to an address.
+ */
+static bool GetOutputAddress(const CTxOut& out, int& type, uint160& hashBytes, std::string& assetName, CAmount& amount)
+{
+    const CScript& script = out.scriptPubKey;
+    assetName = YAI;
+    amount = out.nValue;
+
+    if (script.IsPayToScriptHash()) {
+        type = 2;
+        hashBytes = uint160(std::vector<unsigned char>(script.begin() + 2, script.begin() + 22));
+    } else if (script.IsPayToPublicKeyHash()) {
+        type = 1;
+        hashBytes = uint160(std::vector<unsigned char>(script.begin() + 3, script.begin() + 23));
+    } else if (script.IsPayToPublicKey()) {
+        type = 1;
+        hashBytes = Hash160(script.begin() + 1, script.end() - 1);
+    } else if (ParseAssetScript(script, hashBytes, assetName, amount)) {
+        // Assets are active from the genesis block, so any asset script in the chain is one
+        type = 1;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+/** Check that the undo data has one spent coin for every input of the block */
+static bool CheckBlockUndo(const CBlock& block, const CBlockUndo& blockundo)
+{
+    if (blockundo.vtxundo.size() + 1 != block.vtx.size())
+        return false;
+    for (unsigned int i = 1; i < block.vtx.size(); i++) {
+        if (blockundo.vtxundo[i - 1].vprevout.size() != block.vtx[i]->vin.size())
+            return false;
+    }
+    return true;
+}
+
+bool AddressIndex::WriteBlock(const CBlock& block, const CBlockUndo& blockundo, const CBlockIndex* pindex)
+{
+    if (!CheckBlockUndo(block, blockundo))
+        return error("%s: block and undo data inconsistent", __func__);
+
+    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > addressUnspentIndex;
+
+    int type;
+    uint160 hashBytes;
+    std::string assetName;
+    CAmount amount;
+
+    for (unsigned int i = 0; i < block.vtx.size(); i++) {
+        const CTransaction& tx = *(block.vtx[i]);
+        const uint256 txhash = tx.GetHash();
+
+        if (i > 0) {
+            for (unsigned int j = 0; j < tx.vin.size(); j++) {
+                const Coin& coin = blockundo.vtxundo[i - 1].vprevout[j];
+                if (!GetOutputAddress(coin.out, type, hashBytes, assetName, amount))
+                    continue;
+
+                // record spending activity
+                addressIndex.push_back(std::make_pair(CAddressIndexKey(type, hashBytes, assetName, pindex->nHeight, i, txhash, j, true), amount * -1));
+
+                // remove address from unspent index
+                addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(type, hashBytes, assetName, tx.vin[j].prevout.hash, tx.vin[j].prevout.n), CAddressUnspentValue()));
+            }
+        }
+
+        for (unsigned int k = 0; k < tx.vout.size(); k++) {
+            const CTxOut& out = tx.vout[k];
+            if (!GetOutputAddress(out, type, hashBytes, assetName, amount))
+                continue;
+
+            // record receiving activity
+            addressIndex.push_back(std::make_pair(CAddressIndexKey(type, hashBytes, assetName, pindex->nHeight, i, txhash, k, false), amount));
+
+            // record unspent output
+            addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(type, hashBytes, assetName, txhash, k), CAddressUnspentValue(amount, out.scriptPubKey, pindex->nHeight)));
+        }
+    }
+
+    return pblocktree->WriteAddressIndexBlock(addressIndex, false, addressUnspentIndex, pindex->GetBlockHash());
+}
+
+bool AddressIndex::RewindBlock(const CBlock& block, const CBlockUndo& blockundo, const CBlockIndex* pindex)
+{
+    if (!CheckBlockUndo(block, blockundo))
+        return error("%s: block and undo data inconsistent", __func__);
+
+    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > addressUnspentIndex;
+
+    int type;
+    uint160 hashBytes;
+    std::string assetName;
+    CAmount amount;
+
+    // undo transactions in reverse order, so that outputs spent within the block end up erased
+    for (unsigned int i = block.vtx.size(); i-- > 0;) {
+        const CTransaction& tx = *(block.vtx[i]);
+        const uint256 txhash = tx.GetHash();
+
+        for (unsigned int k = tx.vout.size(); k-- > 0;) {
+            const CTxOut& out = tx.vout[k];
+            if (!GetOutputAddress(out, type, hashBytes, assetName, amount))
+                continue;
+
+            // undo receiving activity
+            addressIndex.push_back(std::make_pair(CAddressIndexKey(type, hashBytes, assetName, pindex->nHeight, i, txhash, k, false), amount));
+
+            // undo unspent index
+            addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(type, hashBytes, assetName, txhash, k), CAddressUnspentValue()));
+        }
+
+        if (i > 0) {
+            for (unsigned int j = tx.vin.size(); j-- > 0;) {
+                const Coin& coin = blockundo.vtxundo[i - 1].vprevout[j];
+                if (!GetOutputAddress(coin.out, type, hashBytes, assetName, amount))
+                    continue;
+
+                // undo spending activity
+                addressIndex.push_back(std::make_pair(CAddressIndexKey(type, hashBytes, assetName, pindex->nHeight, i, txhash, j, true), amount * -1));
+
+                // restore unspent index
+                addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(type, hashBytes, assetName, tx.vin[j].prevout.hash, tx.vin[j].prevout.n), CAddressUnspentValue(amount, coin.out.scriptPubKey, coin.nHeight)));
+            }
+        }
+    }
+
+    return pblocktree->WriteAddressIndexBlock(addressIndex, true, addressUnspentIndex, pindex->pprev->GetBlockHash());
+}
+
+bool SpentIndex::WriteBlock(const CBlock& block, const CBlockUndo& blockundo, const CBlockIndex* pindex)
+{
+    if (!CheckBlockUndo(block, blockundo))
+        return error("%s: block and undo data inconsistent", __func__);
+
+    std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> > spentIndex;
+
+    for (unsigned int i = 1; i < block.vtx.size(); i++) {
+        const CTransaction& tx = *(block.vtx[i]);
+        const uint256 txhash = tx.GetHash();
+
+        for (unsigned int j = 0; j < tx.vin.size(); j++) {
+            const Coin& coin = blockundo.vtxundo[i - 1].vprevout[j];
+            int type = 0;
+            uint160 hashBytes;
+            std::string assetName;
+            CAmount amount;
+            if (!GetOutputAddress(coin.out, type, hashBytes, assetName, amount)) {
+                type = 0;
+                hashBytes.SetNull();
+            }
+
+            // add the spent index to determine the txid and input that spent an output
+            // and to find the amount and address from an input
+            spentIndex.push_back(std::make_pair(CSpentIndexKey(tx.vin[j].prevout.hash, tx.vin[j].prevout.n), CSpentIndexValue(txhash, j, pindex->nHeight, coin.out.nValue, type, hashBytes)));
+        }
+    }
+
+    return pblocktree->WriteSpentIndexBlock(spentIndex, pindex->GetBlockHash());
+}
+
+bool SpentIndex::RewindBlock(const CBlock& block, const CBlockUndo& blockundo, const CBlockIndex* pindex)
+{
+    std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> > spentIndex;
+
+    for (unsigned int i = 1; i < block.vtx.size(); i++) {
+        for (const CTxIn& input : block.vtx[i]->vin) {
+            // undo and delete the spent index
+            spentIndex.push_back(std::make_pair(CSpentIndexKey(input.prevout.hash, input.prevout.n), CSpentIndexValue()));
+        }
+    }
+
+    return pblocktree->WriteSpentIndexBlock(spentIndex, pindex->pprev->GetBlockHash());
+}
+
+bool TimestampIndex::WriteBlock(const CBlock& block, const CBlockUndo& blockundo, const CBlockIndex* pindex)
+{
+    unsigned int logicalTS = pindex->nTime;
+    unsigned int prevLogicalTS = 0;
+
+    // retrieve logical timestamp of the previous block
+    if (pindex->pprev)
+        if (!pblocktree->ReadTimestampBlockIndex(pindex->pprev->GetBlockHash(), prevLogicalTS))
+            LogPrintf("%s: Failed to read previous block's logical timestamp\n", __func__);
+
+    if (logicalTS <= prevLogicalTS) {
+        logicalTS = prevLogicalTS + 1;
+        LogPrintf("%s: Previous logical timestamp is newer Actual[%d] prevLogical[%d] Logical[%d]\n", __func__, pindex->nTime, prevLogicalTS, logicalTS);
+    }
+
+    return pblocktree->WriteTimestampIndexBlock(CTimestampIndexKey(logicalTS, pindex->GetBlockHash()), CTimestampBlockIndexKey(pindex->GetBlockHash()),
+                                                CTimestampBlockIndexValue(logicalTS), pindex->GetBlockHash());
+}
+
+bool TimestampIndex::RewindBlock(const CBlock& block, const CBlockUndo& blockundo, const CBlockIndex* pindex)
+{
+    // Entries of disconnected blocks stay, getblockhashes filters them out with its active chain only option
+    return WriteBestBlock(pindex->pprev);
+}
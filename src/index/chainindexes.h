@@ -0,0 +1,44 @@
+// Copyright (c) 2017-2019 The Raven Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef YOTTAFLUX_INDEX_CHAININDEXES_H
+#define YOTTAFLUX_INDEX_CHAININDEXES_H
+
+#include "index/base.h"
+
+#include <memory>
+
+/** Address index (-addressindex): the balance changes and unspent outputs of each address, by asset */
+class AddressIndex final : public BaseIndex
+{
+protected:
+    bool WriteBlock(const CBlock& block, const CBlockUndo& blockundo, const CBlockIndex* pindex) override;
+    bool RewindBlock(const CBlock& block, const CBlockUndo& blockundo, const CBlockIndex* pindex) override;
+    const char* GetName() const override { return "addressindex"; }
+};
+
+/** Spent index (-spentindex): the input spending each output, with the amount and address it spent */
+class SpentIndex final : public BaseIndex
+{
+protected:
+    bool WriteBlock(const CBlock& block, const CBlockUndo& blockundo, const CBlockIndex* pindex) override;
+    bool RewindBlock(const CBlock& block, const CBlockUndo& blockundo, const CBlockIndex* pindex) override;
+    const char* GetName() const override { return "spentindex"; }
+};
+
+/** Timestamp index (-timestampindex): block hashes by strictly increasing logical block time */
+class TimestampIndex final : public BaseIndex
+{
+protected:
+    bool WriteBlock(const CBlock& block, const CBlockUndo& blockundo, const CBlockIndex* pindex) override;
+    bool RewindBlock(const CBlock& block, const CBlockUndo& blockundo, const CBlockIndex* pindex) override;
+    const char* GetName() const override { return "timestampindex"; }
+};
+
+/** The running indexes, nullptr when disabled */
+extern std::unique_ptr<AddressIndex> g_address_index;
+extern std::unique_ptr<SpentIndex> g_spent_index;
+extern std::unique_ptr<TimestampIndex> g_timestamp_index;
+
+#endif // YOTTAFLUX_INDEX_CHAININDEXES_H
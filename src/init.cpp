@@ -15,11 +15,14 @@
 #include "chain.h"
 #include "chainparams.h"
 #include "checkpoints.h"
+#include "coinsflusher.h"
+#include "coinsprefetch.h"
 #include "compat/sanity.h"
 #include "consensus/validation.h"
 #include "fs.h"
 #include "httpserver.h"
 #include "httprpc.h"
+#include "index/chainindexes.h"
 #include "key.h"
 #include "validation.h"
 #include "miner.h"
@@ -45,6 +48,7 @@
 #include "util.h"
 #include "utilmoneystr.h"
 #include "validationinterface.h"
+#include <crypto/ethash/include/ethash/ethash.hpp>
 #include "assets/assets.h"
 #include "assets/assetdb.h"
 #include "assets/snapshotrequestdb.h"
@@ -237,6 +241,11 @@ void PrepareShutdown()
         FlushStateToDisk();
     }
 
+    // The indexes write to the block tree database, so stop them before it is closed
+    g_address_index.reset();
+    g_spent_index.reset();
+    g_timestamp_index.reset();
+
     // After there are no more peers/RPC left to give us new data which may generate
     // CValidationInterface callbacks, flush them...
     GetMainSignals().FlushBackgroundCallbacks();
@@ -255,9 +264,15 @@ void PrepareShutdown()
         delete pcoinsTip;
         pcoinsTip = nullptr;
 
+        delete pcoinsprefetch;
+        pcoinsprefetch = nullptr;
+
         delete pcoinscatcher;
         pcoinscatcher = nullptr;
 
+        delete pcoinsflusher;
+        pcoinsflusher = nullptr;
+
         delete pcoinsdbview;
         pcoinsdbview = nullptr;
 
@@ -295,11 +310,11 @@ void PrepareShutdown()
         delete passetsVerifierCache;
         passetsVerifierCache = nullptr;
 
-        delete passetsQualifierCache;
-        passetsQualifierCache = nullptr;
+        delete passetsCompiledVerifierCache;
+        passetsCompiledVerifierCache = nullptr;
 
-        delete passetsRestrictionCache;
-        passetsRestrictionCache = nullptr;
+        delete passetsAddressRestrictionCache;
+        passetsAddressRestrictionCache = nullptr;
 
         delete passetsGlobalRestrictionCache;
         passetsGlobalRestrictionCache = nullptr;
@@ -398,6 +413,24 @@ static void registerSignalHandler(int signal, void(*handler)(int))
 }
 #endif
 
+/**
+ * Load an index's best block and start it if enabled. Loading also gives an index written by older versions a best
+ * block of its own, which has to happen even while it is disabled so that enabling it later resumes from there.
+ */
+template <typename Index>
+static bool StartIndex(std::unique_ptr<Index>& index, bool fEnabled)
+{
+    std::unique_ptr<Index> loaded(new Index());
+    if (!loaded->Init())
+        return false;
+
+    if (fEnabled) {
+        loaded->Start();
+        index = std::move(loaded);
+    }
+    return true;
+}
+
 static boost::signals2::connection rpcNotifyBlockChangeConnection;
 
 void OnRPCStarted()
@@ -437,6 +470,7 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-?", _("Print this help message and exit"));
     strUsage += HelpMessageOpt("-version", _("Print version and exit"));
     strUsage += HelpMessageOpt("-alertnotify=<cmd>", _("Execute command when a relevant alert is received or we see a really long fork (%s in cmd is replaced by message)"));
+    strUsage += HelpMessageOpt("-backgroundflush", strprintf(_("Write the chain state to disk on a background thread while blocks keep being validated (default: %u)"), DEFAULT_BACKGROUND_FLUSH));
     strUsage += HelpMessageOpt("-blocknotify=<cmd>", _("Execute command when the best block changes (%s in cmd is replaced by block hash)"));
     if (showDebug)
         strUsage += HelpMessageOpt("-blocksonly", strprintf(_("Whether to operate in a blocks only mode (default: %u)"), DEFAULT_BLOCKSONLY));
@@ -468,9 +502,12 @@ std::string HelpMessage(HelpMessageMode mode)
     }
     strUsage += HelpMessageOpt("-rewardauthority=<address>", _("Address of the trusted reward authority. When set, YFX_REWARD markers in blocks will be scanned during -reindex to reconstruct reward_txid fields in the staking index. (default: empty, disabled)"));
     strUsage += HelpMessageOpt("-persistmempool", strprintf(_("Whether to save the mempool on shutdown and load on restart (default: %u)"), DEFAULT_PERSIST_MEMPOOL));
+    strUsage += HelpMessageOpt("-persistkawpowcache", strprintf(_("Whether to save KAWPOW light caches in the data directory and load them instead of rebuilding them (default: %u)"), DEFAULT_PERSIST_KAWPOW_CACHE));
     strUsage += HelpMessageOpt("-blockreconstructionextratxn=<n>", strprintf(_("Extra transactions to keep in memory for compact block reconstructions (default: %u)"), DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN));
     strUsage += HelpMessageOpt("-par=<n>", strprintf(_("Set the number of script verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)"),
         -GetNumCores(), MAX_SCRIPTCHECK_THREADS, DEFAULT_SCRIPTCHECK_THREADS));
+    strUsage += HelpMessageOpt("-prefetchthreads=<n>", strprintf(_("Set the number of threads reading block inputs from the coins database ahead of block validation (0 to %d, default: %d)"),
+        MAX_PREFETCH_THREADS, DEFAULT_PREFETCH_THREADS));
     strUsage += HelpMessageOpt("-autofixmempool", strprintf(_("When set, if the CreateNewBlock fails because of a transaction. The mempool will be cleared. (default: %d)"), false));
     strUsage += HelpMessageOpt("-bypassdownload", strprintf(_("When set, if the chain is in initialblockdownload the getblocktemplate rpc call will still return block data (default: %d)"), false));
 #ifndef WIN32
@@ -610,6 +647,7 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-blockmaxweight=<n>", strprintf(_("Set maximum BIP141 block weight (default: %d)"), MAX_BLOCK_WEIGHT - 4000));
     strUsage += HelpMessageOpt("-blockmaxsize=<n>", _("Set maximum BIP141 block weight to this * 4. Deprecated, use blockmaxweight"));
     strUsage += HelpMessageOpt("-blockmintxfee=<amt>", strprintf(_("Set lowest fee rate (in %s/kB) for transactions to be included in block creation. (default: %s)"), CURRENCY_UNIT, FormatMoney(DEFAULT_BLOCK_MIN_TX_FEE)));
+    strUsage += HelpMessageOpt("-minerfulldag", strprintf(_("Let the built-in miner build the full KAWPOW dataset instead of hashing from the light cache. Much faster, but uses over 1GB of memory (default: %u)"), DEFAULT_MINER_FULL_DAG));
     if (showDebug)
         strUsage += HelpMessageOpt("-blockversion=<n>", "Override block version to test forking scenarios");
 
@@ -1014,10 +1052,16 @@ bool AppInitParameterInteraction()
 
     // also see: InitParameterInteraction()
 
-    // if using block pruning, then disallow txindex
+    // if using block pruning, then disallow txindex and the indexes built from the blocks on disk
     if (gArgs.GetArg("-prune", 0)) {
         if (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX))
             return InitError(_("Prune mode is incompatible with -txindex."));
+        if (gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX))
+            return InitError(_("Prune mode is incompatible with -addressindex."));
+        if (gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX))
+            return InitError(_("Prune mode is incompatible with -spentindex."));
+        if (gArgs.GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX))
+            return InitError(_("Prune mode is incompatible with -timestampindex."));
     }
 
     // -bind and -whitebind can't be set when not listening
@@ -1355,10 +1399,18 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
     InitSignatureCache();
     InitScriptExecutionCache();
 
-    LogPrintf("Using %u threads for script verification\n", nScriptCheckThreads);
+    if (gArgs.GetBoolArg("-persistkawpowcache", DEFAULT_PERSIST_KAWPOW_CACHE)) {
+        fs::path kawpowDir = GetDataDir() / "kawpow";
+        TryCreateDirectories(kawpowDir);
+        ethash::set_global_light_cache_dir(kawpowDir.string().c_str());
+    }
+
+    LogPrintf("Using %u threads for script and header proof of work verification\n", nScriptCheckThreads);
     if (nScriptCheckThreads) {
         for (int i=0; i<nScriptCheckThreads-1; i++)
             threadGroup.create_thread(&ThreadScriptCheck);
+        for (int i=0; i<nScriptCheckThreads-1; i++)
+            threadGroup.create_thread(&ThreadHeaderCheck);
     }
 
     // Start the lightweight task scheduler thread
@@ -1522,6 +1574,11 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
     int64_t nBlockTreeDBCache = nTotalCache / 8;
     nBlockTreeDBCache = std::min(nBlockTreeDBCache, (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX) ? nMaxBlockDBAndTxIndexCache : nMaxBlockDBCache) << 20);
     nTotalCache -= nBlockTreeDBCache;
+    if (!gArgs.GetBoolArg("-disablemessaging", false)) {
+        nMessageDirtyCacheLimit = std::min(nTotalCache / 32, nMaxMessageDirtyCache << 20);
+        nMessageDirtyCacheLimit = std::max(nMessageDirtyCacheLimit, nMinMessageDirtyCache << 20);
+        nTotalCache -= nMessageDirtyCacheLimit;
+    }
     int64_t nCoinDBCache = std::min(nTotalCache / 2, (nTotalCache / 4) + (1 << 23)); // use 25%-50% of the remainder for disk cache
     nCoinDBCache = std::min(nCoinDBCache, nMaxCoinsDBCache << 20); // cap total coins db cache
     nTotalCache -= nCoinDBCache;
@@ -1530,6 +1587,8 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
     LogPrintf("Cache configuration:\n");
     LogPrintf("* Using %.1fMiB for block index database\n", nBlockTreeDBCache * (1.0 / 1024 / 1024));
     LogPrintf("* Using %.1fMiB for chain state database\n", nCoinDBCache * (1.0 / 1024 / 1024));
+    if (!gArgs.GetBoolArg("-disablemessaging", false))
+        LogPrintf("* Using %.1fMiB for dirty message caches\n", nMessageDirtyCacheLimit * (1.0 / 1024 / 1024));
     LogPrintf("* Using %.1fMiB for in-memory UTXO set (plus up to %.1fMiB of unused mempool space)\n", nCoinCacheUsage * (1.0 / 1024 / 1024), nMempoolSizeMax * (1.0 / 1024 / 1024));
 
     bool fLoaded = false;
@@ -1544,8 +1603,10 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
             try {
                 UnloadBlockIndex();
                 delete pcoinsTip;
-                delete pcoinsdbview;
+                delete pcoinsprefetch;
                 delete pcoinscatcher;
+                delete pcoinsflusher;
+                delete pcoinsdbview;
                 delete pblocktree;
                 pblocktree = new CBlockTreeDB(nBlockTreeDBCache, false, fReset, dbMaxFileSize);
 
@@ -1569,8 +1630,8 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                     // Restricted assets
                     delete prestricteddb;
                     delete passetsVerifierCache;
-                    delete passetsQualifierCache;
-                    delete passetsRestrictionCache;
+                    delete passetsCompiledVerifierCache;
+                    delete passetsAddressRestrictionCache;
                     delete passetsGlobalRestrictionCache;
 
                     //  Rewards
@@ -1593,6 +1654,12 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                     pmessagedb = new CMessageDB(nBlockTreeDBCache, false, false);
                     pmessagechanneldb = new CMessageChannelDB(nBlockTreeDBCache, false, false);
 
+                    // Messages stored before the channel index existed get indexed once
+                    if (!pmessagedb->BuildMessageIndex()) {
+                        strLoadError = _("Failed to build the message index");
+                        break;
+                    }
+
                     // My restricted assets
                     pmyrestricteddb = new CMyRestrictedDB(nBlockTreeDBCache, false, false);
 
@@ -1600,8 +1667,10 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                     prestricteddb = new CRestrictedDB(nBlockTreeDBCache, false, fReset);
                     passetsVerifierCache = new CLRUCache<std::string, CNullAssetTxVerifierString>(
                             MAX_CACHE_ASSETS_SIZE);
-                    passetsQualifierCache = new CLRUCache<std::string, int8_t>(MAX_CACHE_ASSETS_SIZE);
-                    passetsRestrictionCache = new CLRUCache<std::string, int8_t>(MAX_CACHE_ASSETS_SIZE);
+                    passetsCompiledVerifierCache = new CLRUCache<std::string, std::shared_ptr<const CCompiledVerifierString>>(
+                            MAX_CACHE_ASSETS_SIZE);
+                    passetsAddressRestrictionCache = new CLRUCache<std::string, std::shared_ptr<const CAddressRestrictionData>>(
+                            MAX_CACHE_ASSETS_SIZE);
                     passetsGlobalRestrictionCache = new CLRUCache<std::string, int8_t>(MAX_CACHE_ASSETS_SIZE);
 
                     // Rewards
@@ -1667,24 +1736,6 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                     break;
                 }
 
-                // Check for changed -addressindex state
-                if (fAddressIndex != gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX)) {
-                    strLoadError = _("You need to rebuild the database using -reindex-chainstate to change -addressindex");
-                    break;
-                }
-
-                // Check for changed -spentindex state
-                if (fSpentIndex != gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX)) {
-                    strLoadError = _("You need to rebuild the database using -reindex-chainstate to change -spentindex");
-                    break;
-                }
-
-                // Check for changed -timestampindex state
-                if (fTimestampIndex != gArgs.GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX)) {
-                    strLoadError = _("You need to rebuild the database using -reindex-chainstate to change -timestampindex");
-                    break;
-                }
-
                 // Check for changed -prune state.  What we are concerned about is a user who has pruned blocks
                 // in the past, but is now trying to run unpruned.
                 if (fHavePruned && !fPruneMode) {
@@ -1705,7 +1756,8 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                 // block tree into mapBlockIndex!
 
                 pcoinsdbview = new CCoinsViewDB(nCoinDBCache, false, fReset || fReindexChainState);
-                pcoinscatcher = new CCoinsViewErrorCatcher(pcoinsdbview);
+                pcoinsflusher = new CCoinsViewFlusher(pcoinsdbview, gArgs.GetBoolArg("-backgroundflush", DEFAULT_BACKGROUND_FLUSH));
+                pcoinscatcher = new CCoinsViewErrorCatcher(pcoinsflusher);
 
                 // If necessary, upgrade from older database format.
                 // This is a no-op if we cleared the coinsviewdb with -reindex or -reindex-chainstate
@@ -1714,6 +1766,12 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                     break;
                 }
 
+                // Likewise for the address index, which may be upgraded even while it is disabled
+                if (!pblocktree->UpgradeAddressIndex()) {
+                    strLoadError = _("Error upgrading address index database");
+                    break;
+                }
+
                 // ReplayBlocks is a no-op if we cleared the coinsviewdb with -reindex or -reindex-chainstate
                 if (!ReplayBlocks(chainparams, pcoinsdbview)) {
                     strLoadError = _("Unable to replay blocks. You will need to rebuild the database using -reindex-chainstate.");
@@ -1721,7 +1779,9 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                 }
 
                 // The on-disk coinsdb is now in a good state, create the cache
-                pcoinsTip = new CCoinsViewCache(pcoinscatcher);
+                int nPrefetchThreads = std::max(0, std::min((int)gArgs.GetArg("-prefetchthreads", DEFAULT_PREFETCH_THREADS), MAX_PREFETCH_THREADS));
+                pcoinsprefetch = new CCoinsViewPrefetch(pcoinscatcher, nPrefetchThreads);
+                pcoinsTip = new CCoinsViewCache(pcoinsprefetch);
 
                 bool is_coinsview_empty = fReset || fReindexChainState || pcoinsTip->GetBestBlock().IsNull();
                 if (!is_coinsview_empty) {
@@ -1817,6 +1877,18 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
         ::feeEstimator.Read(est_filein);
     fFeeEstimatesInitialized = true;
 
+    // Start the address, spent and timestamp indexes. Each catches up with the chain from its own best block in the
+    // background, so they can be turned on and off without a reindex
+    fAddressIndex = gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX);
+    fSpentIndex = gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX);
+    fTimestampIndex = gArgs.GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX);
+    if (!StartIndex(g_address_index, fAddressIndex))
+        return InitError(_("Error loading the address index"));
+    if (!StartIndex(g_spent_index, fSpentIndex))
+        return InitError(_("Error loading the spent index"));
+    if (!StartIndex(g_timestamp_index, fTimestampIndex))
+        return InitError(_("Error loading the timestamp index"));
+
     // ********************************************************* Step 8: load wallet
 #ifdef ENABLE_WALLET
     if (!OpenWallets())
@@ -6,6 +6,7 @@
 #ifndef YOTTAFLUX_MEMUSAGE_H
 #define YOTTAFLUX_MEMUSAGE_H
 
+#include "flathashmap.h"
 #include "indirectmap.h"
 
 #include <stdlib.h>
@@ -165,6 +166,20 @@ static inline size_t DynamicUsage(const std::unordered_map<X, Y, Z>& m)
     return MallocUsage(sizeof(unordered_node<std::pair<const X, Y> >)) * m.size() + MallocUsage(sizeof(void*) * m.bucket_count());
 }
 
+template<typename X, typename Y, typename Z>
+static inline size_t DynamicUsage(const flathashmap<X, Y, Z>& m)
+{
+    typedef flathashmap<X, Y, Z> map_type;
+    size_t usage = MallocUsage(sizeof(typename map_type::slot_type) * m.bucket_count()) +
+                   MallocUsage(sizeof(void*) * m.chunk_count()) + MallocUsage(sizeof(uint32_t) * m.free_list_capacity());
+    // Past the first few, all chunks are the same size
+    for (size_t c = 0; c < m.chunk_count() && c <= 9; c++)
+        usage += MallocUsage(sizeof(typename map_type::node_type) * map_type::chunk_nodes(c));
+    if (m.chunk_count() > 10)
+        usage += MallocUsage(sizeof(typename map_type::node_type) * map_type::MAX_CHUNK_NODES) * (m.chunk_count() - 10);
+    return usage;
+}
+
 }
 
 #endif // YOTTAFLUX_MEMUSAGE_H
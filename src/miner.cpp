@@ -35,6 +35,8 @@
 #include <boost/thread.hpp>
 #include <algorithm>
 #include <base58.h>
+#include <limits>
+#include <crypto/ethash/include/ethash/progpow.hpp>
 #include <queue>
 #include <utility>
 
@@ -54,8 +56,8 @@ extern std::vector<CWalletRef> vpwallets;
 uint64_t nLastBlockTx = 0;
 uint64_t nLastBlockWeight = 0;
 uint64_t nMiningTimeStart = 0;
-uint64_t nHashesPerSec = 0;
-uint64_t nHashesDone = 0;
+std::atomic<uint64_t> nHashesPerSec{0};
+std::atomic<uint64_t> nHashesDone{0};
 
 
 int64_t UpdateTime(CBlockHeader* pblock, const Consensus::Params& consensusParams, const CBlockIndex* pindexPrev)
@@ -564,6 +566,42 @@ static bool ProcessBlockFound(const CBlock* pblock, const CChainParams& chainpar
     return true;
 }
 
+bool SearchKAWPOWNonce(CBlockHeader& block, uint64_t nStartNonce, uint64_t nIterations, uint64_t& nHashes, bool fFullDag)
+{
+    nHashes = 0;
+
+    bool fNegative;
+    bool fOverflow;
+    arith_uint256 bnTarget;
+    bnTarget.SetCompact(block.nBits, &fNegative, &fOverflow);
+    if (fNegative || bnTarget == 0 || fOverflow)
+        return false;
+
+    const auto boundary = to_hash256(ArithToUint256(bnTarget));
+    const auto header_hash = to_hash256(block.GetKAWPOWHeaderHash());
+    const int epoch_number = ethash::get_epoch_number(block.nHeight);
+
+    ethash::search_result result;
+    const ethash::epoch_context_full* context_full = fFullDag ? ethash_get_global_epoch_context_full(epoch_number) : nullptr;
+    if (context_full) {
+        result = progpow::search(*context_full, block.nHeight, header_hash, boundary, nStartNonce, nIterations);
+    } else {
+        const auto& context = ethash::get_global_epoch_context(epoch_number);
+        result = progpow::search_light(context, block.nHeight, header_hash, boundary, nStartNonce, nIterations);
+    }
+
+    // A miss leaves the result zeroed
+    if (result.final_hash == ethash::hash256{}) {
+        nHashes = nIterations;
+        return false;
+    }
+
+    nHashes = result.nonce - nStartNonce + 1;
+    block.nNonce64 = result.nonce;
+    block.mix_hash = to_uint256(result.mix_hash);
+    return true;
+}
+
 CWallet *GetFirstWallet() {
 #ifdef ENABLE_WALLET
     while(vpwallets.size() == 0){
@@ -577,13 +615,14 @@ CWallet *GetFirstWallet() {
     return(NULL);
 }
 
-void static YottafluxMiner(const CChainParams& chainparams)
+void static YottafluxMiner(const CChainParams& chainparams, int nThreadIndex, int nThreads)
 {
     LogPrintf("YottafluxMiner -- started\n");
     SetThreadPriority(THREAD_PRIORITY_LOWEST);
     RenameThread("yottaflux-miner");
 
     unsigned int nExtraNonce = 0;
+    const bool fFullDag = gArgs.GetBoolArg("-minerfulldag", DEFAULT_MINER_FULL_DAG);
 
 
     CWallet * pWallet = NULL;
@@ -669,38 +708,60 @@ void static YottafluxMiner(const CChainParams& chainparams)
             //
             int64_t nStart = GetTime();
             arith_uint256 hashTarget = arith_uint256().SetCompact(pblock->nBits);
+
+            // All threads work on the same template, so each KAWPOW thread searches its own
+            // slice of the 64 bit nonce space
+            const uint64_t nNonceSlice = std::numeric_limits<uint64_t>::max() / nThreads;
+            pblock->nNonce64 = nNonceSlice * nThreadIndex;
+            bool fFound = false;
             while (true)
             {
-
                 uint256 hash;
                 uint256 mix_hash;
-                while (true)
-                {
-                    hash = pblock->GetHashFull(mix_hash);
-                    if (UintToArith256(hash) <= hashTarget)
+                if (pblock->nTime >= nKAWPOWActivationTime) {
+                    // Search in small batches so a new tip or a stop request is noticed quickly
+                    uint64_t nHashes = 0;
+                    fFound = SearchKAWPOWNonce(*pblock, pblock->nNonce64, KAWPOW_SEARCH_BATCH, nHashes, fFullDag);
+                    if (fFound)
+                        hash = pblock->GetHash();
+                    else
+                        pblock->nNonce64 += nHashes;
+                    nHashesDone += nHashes;
+                    nHashesPerSec = nHashesDone / (((GetTimeMicros() - nMiningTimeStart) / 1000000) + 1);
+                } else {
+                    while (true)
                     {
-                        pblock->mix_hash = mix_hash;
-                        // Found a solution
-                        SetThreadPriority(THREAD_PRIORITY_NORMAL);
-                        LogPrintf("YottafluxMiner:\n  proof-of-work found\n  hash: %s\n  target: %s\n", hash.GetHex(), hashTarget.GetHex());
-                        ProcessBlockFound(pblock, chainparams);
-                        SetThreadPriority(THREAD_PRIORITY_LOWEST);
-                        coinbaseScript->KeepScript();
-
-                        // In regression test mode, stop mining after a block is found. This
-                        // allows developers to controllably generate a block on demand.
-                        if (chainparams.MineBlocksOnDemand())
-                            throw boost::thread_interrupted();
-
-                        break;
+                        hash = pblock->GetHashFull(mix_hash);
+                        if (UintToArith256(hash) <= hashTarget) {
+                            pblock->mix_hash = mix_hash;
+                            fFound = true;
+                            break;
+                        }
+                        pblock->nNonce += 1;
+                        nHashesDone += 1;
+                        if (nHashesDone % 500000 == 0) {   //Calculate hashing speed
+                            nHashesPerSec = nHashesDone / (((GetTimeMicros() - nMiningTimeStart) / 1000000) + 1);
+                        }
+                        if ((pblock->nNonce & 0xFF) == 0)
+                            break;
                     }
-                    pblock->nNonce += 1;
-                    nHashesDone += 1;
-                    if (nHashesDone % 500000 == 0) {   //Calculate hashing speed
-                        nHashesPerSec = nHashesDone / (((GetTimeMicros() - nMiningTimeStart) / 1000000) + 1);
-                    } 
-                    if ((pblock->nNonce & 0xFF) == 0)
-                        break;
+                }
+
+                if (fFound)
+                {
+                    // Found a solution
+                    SetThreadPriority(THREAD_PRIORITY_NORMAL);
+                    LogPrintf("YottafluxMiner:\n  proof-of-work found\n  hash: %s\n  target: %s\n", hash.GetHex(), hashTarget.GetHex());
+                    ProcessBlockFound(pblock, chainparams);
+                    SetThreadPriority(THREAD_PRIORITY_LOWEST);
+                    coinbaseScript->KeepScript();
+
+                    // In regression test mode, stop mining after a block is found. This
+                    // allows developers to controllably generate a block on demand.
+                    if (chainparams.MineBlocksOnDemand())
+                        throw boost::thread_interrupted();
+
+                    break;
                 }
 
                 // Check for stop or if block needs to be rebuilt
@@ -708,7 +769,7 @@ void static YottafluxMiner(const CChainParams& chainparams)
                 // Regtest mode doesn't require peers
                 //if (vNodes.empty() && chainparams.MiningRequiresPeers())
                 //    break;
-                if (pblock->nNonce >= 0xffff0000)
+                if (pblock->nNonce >= 0xffff0000 || pblock->nNonce64 - nNonceSlice * nThreadIndex >= nNonceSlice)
                     break;
                 if (mempool.GetTransactionsUpdated() != nTransactionsUpdatedLast && GetTime() - nStart > 60)
                     break;
@@ -766,7 +827,7 @@ int GenerateYottafluxs(bool fGenerate, int nThreads, const CChainParams& chainpa
     nHashesPerSec = 0;
 
     for (int i = 0; i < nThreads; i++){
-        minerThreads->create_thread(boost::bind(&YottafluxMiner, boost::cref(chainparams)));
+        minerThreads->create_thread(boost::bind(&YottafluxMiner, boost::cref(chainparams), i, nThreads));
     }
 
     return(numCores);
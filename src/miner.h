@@ -10,6 +10,7 @@
 #include "primitives/block.h"
 #include "txmempool.h"
 
+#include <atomic>
 #include <stdint.h>
 #include <memory>
 #include <boost/multi_index_container.hpp>
@@ -22,6 +23,13 @@ class CScript;
 namespace Consensus { struct Params; };
 
 static const bool DEFAULT_PRINTPRIORITY = false;
+/** Default for -minerfulldag, build the full KAWPOW dataset for the built-in miner */
+static const bool DEFAULT_MINER_FULL_DAG = false;
+/** Number of KAWPOW nonces a miner thread tries before checking for a new tip */
+static const uint64_t KAWPOW_SEARCH_BATCH = 64;
+
+extern std::atomic<uint64_t> nHashesPerSec;
+extern std::atomic<uint64_t> nHashesDone;
 
 struct CBlockTemplate
 {
@@ -206,5 +214,12 @@ private:
 void IncrementExtraNonce(CBlock* pblock, const CBlockIndex* pindexPrev, unsigned int& nExtraNonce);
 int64_t UpdateTime(CBlockHeader* pblock, const Consensus::Params& consensusParams, const CBlockIndex* pindexPrev);
 
+/**
+ * Search the KAWPOW nonces [nStartNonce, nStartNonce + nIterations) for one meeting the
+ * target in block.nBits. On success nNonce64 and mix_hash of the block are set to the
+ * solution. nHashes is set to the number of nonces tried.
+ */
+bool SearchKAWPOWNonce(CBlockHeader& block, uint64_t nStartNonce, uint64_t nIterations, uint64_t& nHashes, bool fFullDag = false);
+
 int GenerateYottafluxs(bool fGenerate, int nThreads, const CChainParams& chainparams);
 #endif // YOTTAFLUX_MINER_H
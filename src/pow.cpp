@@ -197,3 +197,19 @@ bool CheckProofOfWork(uint256 hash, unsigned int nBits, const Consensus::Params&
 
     return true;
 }
+
+bool CheckProofOfWork(const std::vector<CBlockHeader>& headers, const Consensus::Params& params, size_t& nFailed)
+{
+    for (size_t i = 0; i < headers.size(); i++) {
+        const CBlockHeader& header = headers[i];
+
+        uint256 mix_hash;
+        if (!CheckProofOfWork(header.GetHashFull(mix_hash), header.nBits, params) ||
+            (header.nTime >= nKAWPOWActivationTime && mix_hash != header.mix_hash)) {
+            nFailed = i;
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -10,6 +10,7 @@
 #include "consensus/params.h"
 
 #include <stdint.h>
+#include <vector>
 
 class CBlockHeader;
 class CBlockIndex;
@@ -21,4 +22,8 @@ unsigned int CalculateNextWorkRequired(const CBlockIndex* pindexLast, int64_t nF
 /** Check whether a block hash satisfies the proof-of-work requirement specified by nBits */
 bool CheckProofOfWork(uint256 hash, unsigned int nBits, const Consensus::Params&);
 
+/** Check the proof of work of a run of headers: the full hash against nBits, and for KAWPOW headers the mix_hash too.
+ *  On failure, nFailed is set to the index of the first header that failed. */
+bool CheckProofOfWork(const std::vector<CBlockHeader>& headers, const Consensus::Params&, size_t& nFailed);
+
 #endif // YOTTAFLUX_POW_H
@@ -35,7 +35,60 @@ void BlockNetwork::SetNetwork(const std::string& net)
     }
 }
 
+struct CBlockHashMemo::Entry
+{
+    int32_t nVersion;
+    uint256 hashPrevBlock;
+    uint256 hashMerkleRoot;
+    uint32_t nTime;
+    uint32_t nBits;
+    uint32_t nNonce;
+    uint32_t nHeight;
+    uint64_t nNonce64;
+    uint256 mix_hash;
+
+    uint256 hash;
+
+    Entry(const CBlockHeader& header, const uint256& hashIn) :
+        nVersion(header.nVersion), hashPrevBlock(header.hashPrevBlock), hashMerkleRoot(header.hashMerkleRoot),
+        nTime(header.nTime), nBits(header.nBits), nNonce(header.nNonce),
+        nHeight(header.nHeight), nNonce64(header.nNonce64), mix_hash(header.mix_hash), hash(hashIn) {}
+
+    bool Matches(const CBlockHeader& header) const
+    {
+        return nVersion == header.nVersion && hashPrevBlock == header.hashPrevBlock &&
+               hashMerkleRoot == header.hashMerkleRoot && nTime == header.nTime && nBits == header.nBits &&
+               nNonce == header.nNonce && nHeight == header.nHeight && nNonce64 == header.nNonce64 &&
+               mix_hash == header.mix_hash;
+    }
+};
+
+bool CBlockHashMemo::Get(const CBlockHeader& header, uint256& hash) const
+{
+    std::shared_ptr<const Entry> current = std::atomic_load(&entry);
+    if (!current || !current->Matches(header))
+        return false;
+    hash = current->hash;
+    return true;
+}
+
+void CBlockHashMemo::Set(const CBlockHeader& header, const uint256& hash)
+{
+    std::atomic_store(&entry, std::shared_ptr<const Entry>(std::make_shared<Entry>(header, hash)));
+}
+
 uint256 CBlockHeader::GetHash() const
+{
+    uint256 hash;
+    if (hashMemo.Get(*this, hash))
+        return hash;
+
+    hash = ComputeHash();
+    hashMemo.Set(*this, hash);
+    return hash;
+}
+
+uint256 CBlockHeader::ComputeHash() const
 {
     if (nTime < nKAWPOWActivationTime) {
         uint32_t nTimeToUse = MAINNET_X16RV2ACTIVATIONTIME;
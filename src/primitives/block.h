@@ -11,6 +11,8 @@
 #include "serialize.h"
 #include "uint256.h"
 
+#include <memory>
+
 /** Nodes collect new transactions into a block, hash them into a hash tree,
  * and scan through nonce values to make the block's hash satisfy proof-of-work
  * requirements.  When they solve the proof-of-work, they broadcast the block
@@ -32,6 +34,33 @@ public:
 
 extern BlockNetwork bNetwork;
 
+class CBlockHeader;
+
+/**
+ * Memo of a block header's hash. The fields the hash was computed from are stored
+ * with it, so any later change to the header makes it miss instead of returning a
+ * stale hash. The memo is swapped atomically, so threads sharing a header may all
+ * call GetHash() on it.
+ */
+class CBlockHashMemo
+{
+private:
+    struct Entry;
+    std::shared_ptr<const Entry> entry;
+
+public:
+    CBlockHashMemo() {}
+    CBlockHashMemo(const CBlockHashMemo& other) : entry(std::atomic_load(&other.entry)) {}
+    CBlockHashMemo& operator=(const CBlockHashMemo& other)
+    {
+        std::atomic_store(&entry, std::atomic_load(&other.entry));
+        return *this;
+    }
+
+    bool Get(const CBlockHeader& header, uint256& hash) const;
+    void Set(const CBlockHeader& header, const uint256& hash);
+    void Clear() { std::atomic_store(&entry, std::shared_ptr<const Entry>()); }
+};
 
 class CBlockHeader
 {
@@ -50,6 +79,9 @@ public:
     uint64_t nNonce64;
     uint256 mix_hash;
 
+    // memory only
+    mutable CBlockHashMemo hashMemo;
+
     CBlockHeader()
     {
         SetNull();
@@ -85,6 +117,7 @@ public:
         nNonce64 = 0;
         nHeight = 0;
         mix_hash.SetNull();
+        hashMemo.Clear();
     }
 
     bool IsNull() const
@@ -93,6 +126,8 @@ public:
     }
 
     uint256 GetHash() const;
+    /** Remember the hash of this header when it is already known, e.g. from its block index entry. */
+    void MemoizeHash(const uint256& hash) const { hashMemo.Set(*this, hash); }
     uint256 GetX16RHash() const;
     uint256 GetX16RV2Hash() const;
 
@@ -109,6 +144,9 @@ public:
     {
         return (int64_t)nTime;
     }
+
+private:
+    uint256 ComputeHash() const;
 };
 
 
@@ -162,6 +200,8 @@ public:
         block.nHeight        = nHeight;
         block.nNonce64       = nNonce64;
         block.mix_hash       = mix_hash;
+
+        block.hashMemo       = hashMemo;
         return block;
     }
 
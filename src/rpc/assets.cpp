@@ -1789,6 +1789,13 @@ UniValue getcacheinfo(const JSONRPCRequest& request)
                 "  asset metadata map:\n"
                 "  asset metadata list (est):\n"
                 "  dirty cache (est):\n"
+                "  message data:\n"
+                "    dirty cache (est):\n"
+                "    dirty cache limit:\n"
+                "    flushes:\n"
+                "    last flush size (est):\n"
+                "    last flush time (ms):\n"
+                "    total flush time (ms):\n"
 
 
                 "]\n"
@@ -1826,6 +1833,20 @@ UniValue getcacheinfo(const JSONRPCRequest& request)
     info.push_back(Pair("dirty cache (est)",  (int)currentActiveAssetCache->GetCacheSize()));
     info.push_back(Pair("dirty cache V2 (est)",  (int)currentActiveAssetCache->GetCacheSizeV2()));
 
+    if (fMessaging) {
+        LOCK(cs_messaging);
+        CMessageFlushStats stats = GetMessageFlushStats();
+
+        UniValue messaging(UniValue::VOBJ);
+        messaging.push_back(Pair("dirty cache (est)", (int)GetMessageDirtyCacheSize()));
+        messaging.push_back(Pair("dirty cache limit", nMessageDirtyCacheLimit));
+        messaging.push_back(Pair("flushes", stats.nFlushes));
+        messaging.push_back(Pair("last flush size (est)", (int)stats.nLastFlushSize));
+        messaging.push_back(Pair("last flush time (ms)", stats.nLastFlushMicros * 0.001));
+        messaging.push_back(Pair("total flush time (ms)", stats.nTotalFlushMicros * 0.001));
+        info.push_back(Pair("message data", messaging));
+    }
+
     result.push_back(info);
     return result;
 }
@@ -2232,7 +2253,7 @@ UniValue checkaddresstag(const JSONRPCRequest& request)
     if (!prestricteddb)
         throw JSONRPCError(RPC_DATABASE_ERROR, "Restricted asset database not available");
 
-    if (!passetsQualifierCache)
+    if (!passetsAddressRestrictionCache)
         throw JSONRPCError(RPC_DATABASE_ERROR, "Qualifier cache not available");
 
     if (!passets)
@@ -2273,7 +2294,7 @@ UniValue checkaddressrestriction(const JSONRPCRequest& request)
     if (!prestricteddb)
         throw JSONRPCError(RPC_DATABASE_ERROR, "Restricted asset database not available");
 
-    if (!passetsRestrictionCache)
+    if (!passetsAddressRestrictionCache)
         throw JSONRPCError(RPC_DATABASE_ERROR, "Restriction cache not available");
 
     if (!passets)
@@ -13,6 +13,7 @@
 #include "checkpoints.h"
 #include "coins.h"
 #include "consensus/validation.h"
+#include "index/chainindexes.h"
 #include "validation.h"
 #include "core_io.h"
 #include "policy/feerate.h"
@@ -754,6 +755,9 @@ UniValue getblockdeltas(const JSONRPCRequest& request)
     if (request.fHelp || request.params.size() != 1)
         throw std::runtime_error("");
 
+    if (g_spent_index)
+        g_spent_index->BlockUntilSyncedToCurrentChain();
+
     std::string strHash = request.params[0].get_str();
     uint256 hash(uint256S(strHash));
 
@@ -820,6 +824,9 @@ UniValue getblockhashes(const JSONRPCRequest& request)
         }
     }
 
+    if (g_timestamp_index)
+        g_timestamp_index->BlockUntilSyncedToCurrentChain();
+
     std::vector<std::pair<uint256, unsigned int> > blockHashes;
 
     if (fActiveOnly)
@@ -204,6 +204,9 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "listassetbalancesbyaddress", 2, "count"},
     { "listassetbalancesbyaddress", 3, "start"},
     { "sendmessage", 2, "expire_time"},
+    { "viewallmessages", 1, "from_time"},
+    { "viewallmessages", 2, "to_time"},
+    { "viewallmessages", 3, "count"},
     { "requestsnapshot", 1, "block_height"},
     { "getsnapshotrequest", 1, "block_height"},
     { "listsnapshotrequests", 1, "block_height"},
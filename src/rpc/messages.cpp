@@ -39,12 +39,18 @@ std::string MessageActivationWarning()
 }
 
 UniValue viewallmessages(const JSONRPCRequest& request) {
-    if (request.fHelp || !AreMessagesDeployed() || request.params.size() != 0)
+    if (request.fHelp || !AreMessagesDeployed() || request.params.size() > 4)
         throw std::runtime_error(
-                "viewallmessages \n"
+                "viewallmessages ( \"channel_name\" from_time to_time count )\n"
                 + MessageActivationWarning() +
                 "\nView all messages that the wallet contains\n"
 
+                "\nArguments:\n"
+                "1. \"channel_name\"             (string, optional, default=\"\") Only show messages sent on this channel, empty for all channels\n"
+                "2. from_time                  (numeric, optional, default=0) Only show messages with a time at or after this UTC timestamp\n"
+                "3. to_time                    (numeric, optional) Only show messages with a time at or before this UTC timestamp\n"
+                "4. count                      (numeric, optional, default=0) Maximum number of messages to show, 0 for no limit\n"
+
                 "\nResult:\n"
                 "\"Asset Name:\"                     (string) The name of the asset the message was sent on\n"
                 "\"Message:\"                        (string) The IPFS hash of the message\n"
@@ -57,7 +63,8 @@ UniValue viewallmessages(const JSONRPCRequest& request) {
 
                 "\nExamples:\n"
                 + HelpExampleCli("viewallmessages", "")
-                + HelpExampleRpc("viewallmessages", "")
+                + HelpExampleCli("viewallmessages", "\"ASSET_NAME!\" 1580000000 1590000000 10")
+                + HelpExampleRpc("viewallmessages", "\"ASSET_NAME!\", 1580000000, 1590000000, 10")
         );
 
     if (!fMessaging) {
@@ -72,32 +79,77 @@ UniValue viewallmessages(const JSONRPCRequest& request) {
         return ret;
     }
 
-    std::set<CMessage> setMessages;
+    std::string channel_name = "";
+    if (request.params.size() > 0 && !request.params[0].isNull())
+        channel_name = request.params[0].get_str();
+
+    int64_t nFromTime = 0;
+    if (request.params.size() > 1 && !request.params[1].isNull())
+        nFromTime = std::max<int64_t>(0, request.params[1].get_int64());
+
+    int64_t nToTime = std::numeric_limits<int64_t>::max();
+    if (request.params.size() > 2 && !request.params[2].isNull())
+        nToTime = request.params[2].get_int64();
+
+    int64_t nCount = 0;
+    if (request.params.size() > 3 && !request.params[3].isNull())
+        nCount = request.params[3].get_int64();
+
+    if (nCount < 0)
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "count must be 0 or greater");
 
-    pmessagedb->LoadMessages(setMessages);
+    if (nToTime < nFromTime)
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "to_time must be greater than or equal to from_time");
+
+    auto fMatches = [&](const CMessage& message) {
+        return (channel_name.empty() || message.strName == channel_name) && message.time >= nFromTime && message.time <= nToTime;
+    };
+
+    std::vector<std::string> vChannels;
+    if (channel_name.empty())
+        pmessagedb->LoadMessageChannels(vChannels);
+    else
+        vChannels.emplace_back(channel_name);
+
+    // Dirty removals can hide stored messages, read enough extra from each channel to still fill the count
+    size_t nReadCount = nCount ? nCount + setDirtyMessagesRemove.size() : 0;
+
+    std::map<std::tuple<std::string, int64_t, COutPoint>, CMessage> mapMessages;
+    for (auto channel : vChannels) {
+        std::vector<CMessage> vMessages;
+        pmessagedb->LoadChannelMessages(channel, nFromTime, nToTime, nReadCount, vMessages);
+        for (auto message : vMessages)
+            mapMessages[std::make_tuple(message.strName, message.time, message.out)] = message;
+    }
 
     for (auto pair : mapDirtyMessagesOrphaned) {
         CMessage message = pair.second;
         message.status = MessageStatus::ORPHAN;
-        if (setMessages.count(message))
-            setMessages.erase(message);
-        setMessages.insert(message);
+        if (fMatches(message))
+            mapMessages[std::make_tuple(message.strName, message.time, message.out)] = message;
     }
 
-    for (auto out : setDirtyMessagesRemove) {
-        CMessage message;
-        message.out = out;
-        setMessages.erase(message);
+    if (setDirtyMessagesRemove.size()) {
+        for (auto it = mapMessages.begin(); it != mapMessages.end();) {
+            if (setDirtyMessagesRemove.count(it->second.out))
+                it = mapMessages.erase(it);
+            else
+                ++it;
+        }
     }
 
     for (auto pair : mapDirtyMessagesAdd) {
-        setMessages.erase(pair.second);
-        setMessages.insert(pair.second);
+        if (fMatches(pair.second))
+            mapMessages[std::make_tuple(pair.second.strName, pair.second.time, pair.second.out)] = pair.second;
     }
 
     UniValue messages(UniValue::VARR);
 
-    for (auto message : setMessages) {
+    for (auto pair : mapMessages) {
+        if (nCount && (int64_t)messages.size() >= nCount)
+            break;
+
+        const CMessage& message = pair.second;
         UniValue obj(UniValue::VOBJ);
 
         obj.push_back(Pair("Asset Name", message.strName));
@@ -488,7 +540,7 @@ UniValue viewmyrestrictedaddresses(const JSONRPCRequest& request) {
 static const CRPCCommand commands[] =
     {           //  category    name                          actor (function)             argNames
                 //  ----------- ------------------------      -----------------------      ----------
-            { "messages",       "viewallmessages",            &viewallmessages,            {}},
+            { "messages",       "viewallmessages",            &viewallmessages,            {"channel_name", "from_time", "to_time", "count"}},
             { "messages",       "viewallmessagechannels",     &viewallmessagechannels,     {}},
             { "messages",       "subscribetochannel",         &subscribetochannel,         {"channel_name"}},
             { "messages",       "unsubscribefromchannel",     &unsubscribefromchannel,     {"channel_name"}},
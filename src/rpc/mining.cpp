@@ -35,8 +35,6 @@
 #include <consensus/merkle.h>
 #include <crypto/ethash/include/ethash/progpow.hpp>
 
-extern uint64_t nHashesPerSec;
-
 std::map<std::string, CBlock> mapYAIKAWBlockTemplates;
 
 unsigned int ParseConfirmTarget(const UniValue& value)
@@ -136,26 +134,33 @@ UniValue generateBlocks(std::shared_ptr<CReserveScript> coinbaseScript, int nGen
             LOCK(cs_main);
             IncrementExtraNonce(pblock, chainActive.Tip(), nExtraNonce);
         }
-        uint256 mix_hash;
-        while (nMaxTries > 0 && pblock->nNonce < nInnerLoopCount && !CheckProofOfWork(pblock->GetHashFull(mix_hash), pblock->nBits,
-                                                                                      GetParams().GetConsensus())) {
-            if (pblock->nTime < nKAWPOWActivationTime) {
+        if (pblock->nTime < nKAWPOWActivationTime) {
+            uint256 mix_hash;
+            while (nMaxTries > 0 && pblock->nNonce < nInnerLoopCount && !CheckProofOfWork(pblock->GetHashFull(mix_hash), pblock->nBits,
+                                                                                          GetParams().GetConsensus())) {
                 ++pblock->nNonce;
-            } else  {
-                ++pblock->nNonce64;
+                --nMaxTries;
+            }
+            if (nMaxTries == 0) {
+                break;
+            }
+            if (pblock->nNonce == nInnerLoopCount) {
+                continue;
+            }
+            pblock->mix_hash = mix_hash;
+        } else {
+            // KAWPOW sets nNonce64 and the mix_hash of the block when it finds a solution
+            uint64_t nHashes = 0;
+            bool fFound = SearchKAWPOWNonce(*pblock, 0, std::min<uint64_t>(nMaxTries, nInnerLoopCount), nHashes);
+            nMaxTries -= nHashes;
+            if (!fFound) {
+                if (nMaxTries == 0) {
+                    break;
+                }
+                continue;
             }
-            --nMaxTries;
-        }
-        if (nMaxTries == 0) {
-            break;
-        }
-        if (pblock->nNonce == nInnerLoopCount || pblock->nNonce64 == nInnerLoopCount) {
-            continue;
         }
 
-        // KAWPOW Assign the mix_hash to the block that was found
-        pblock->mix_hash = mix_hash;
-
         std::shared_ptr<const CBlock> shared_pblock = std::make_shared<const CBlock>(*pblock);
         if (!ProcessNewBlock(GetParams(), shared_pblock, true, nullptr))
             throw JSONRPCError(RPC_INTERNAL_ERROR, "ProcessNewBlock, block not accepted");
@@ -809,18 +814,14 @@ static UniValue getkawpowhash(const JSONRPCRequest& request) {
         fCheckTarget = true;
     }
 
-    static ethash::epoch_context_ptr context{nullptr, nullptr};
-
-    // Get the context from the block height
-    const auto epoch_number = ethash::get_epoch_number(nHeight);
-    if (!context || context->epoch_number != epoch_number)
-        context = ethash::create_epoch_context(epoch_number);
+    // Get the context from the block height, shared with block validation
+    const auto& context = ethash::get_global_epoch_context(ethash::get_epoch_number(nHeight));
 
     // ProgPow hash
-    const auto result = progpow::hash(*context, nHeight, header_hash, nNonce);
+    const auto result = progpow::hash(context, nHeight, header_hash, nNonce);
 
-    uint256 mined_mix_hash = uint256S(to_hex(result.mix_hash));
-    uint256 mined_final_hash = uint256S(to_hex(result.final_hash));
+    uint256 mined_mix_hash = to_uint256(result.mix_hash);
+    uint256 mined_final_hash = to_uint256(result.final_hash);
 
     bool mix_hash_match = false;
     bool final_hash_meets_target = false;
@@ -11,6 +11,7 @@
 #include "init.h"
 #include "validation.h"
 #include "httpserver.h"
+#include "index/chainindexes.h"
 #include "net.h"
 #include "netbase.h"
 #include "rpc/blockchain.h"
@@ -856,6 +857,9 @@ UniValue getaddressutxos(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
+    if (g_address_index)
+        g_address_index->BlockUntilSyncedToCurrentChain();
+
     std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > unspentOutputs;
 
     for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
@@ -986,6 +990,9 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
+    if (g_address_index)
+        g_address_index->BlockUntilSyncedToCurrentChain();
+
     std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
 
     for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
@@ -1092,6 +1099,9 @@ UniValue getaddressbalance(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
+    if (g_address_index)
+        g_address_index->BlockUntilSyncedToCurrentChain();
+
     bool includeAssets = false;
     if (request.params.size() > 1) {
         includeAssets = request.params[1].get_bool();
@@ -1221,6 +1231,9 @@ UniValue getaddresstxids(const JSONRPCRequest& request)
         if (!AreAssetsDeployed())
             throw JSONRPCError(RPC_INVALID_PARAMETER, "Assets aren't active.  includeAssets can't be true.");
 
+    if (g_address_index)
+        g_address_index->BlockUntilSyncedToCurrentChain();
+
     std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
 
     for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
@@ -1306,6 +1319,9 @@ UniValue getspentinfo(const JSONRPCRequest& request)
     uint256 txid = ParseHashV(txidValue, "txid");
     int outputIndex = indexValue.get_int();
 
+    if (g_spent_index)
+        g_spent_index->BlockUntilSyncedToCurrentChain();
+
     CSpentIndexKey key(txid, outputIndex);
     CSpentIndexValue value;
 
@@ -9,6 +9,7 @@
 #include "coins.h"
 #include "consensus/validation.h"
 #include "core_io.h"
+#include "index/chainindexes.h"
 #include "init.h"
 #include "keystore.h"
 #include "validation.h"
@@ -183,6 +184,9 @@ UniValue getrawtransaction(const JSONRPCRequest& request)
             + HelpExampleRpc("getrawtransaction", "\"mytxid\", true")
         );
 
+    if (g_spent_index)
+        g_spent_index->BlockUntilSyncedToCurrentChain();
+
     LOCK(cs_main);
 
     uint256 hash = ParseHashV(request.params[0], "parameter 1");